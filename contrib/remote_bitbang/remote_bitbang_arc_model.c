@@ -0,0 +1,430 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+  This is a software model of the JTAG debug interface of an ARC core, to be
+  used as a remote bitbang server for the OpenOCD remote_bitbang interface
+  driver. It makes it possible to measure and regression test the ARC
+  target code (src/target/arc*.c) without hardware.
+
+  The model implements the registers used by src/target/arc_jtag.c: IDCODE,
+  STATUS, transaction command, address and data. Transactions access a
+  simulated core register file, auxiliary registers and a RAM starting at
+  address 0. The core can be halted (DEBUG.FH), resumed (STATUS32.H) and
+  single stepped (DEBUG.IS); it does not execute instructions, a step only
+  advances PC by 4.
+
+  To compile run:
+  gcc -Wall -O2 -std=c99 -o remote_bitbang_arc_model remote_bitbang_arc_model.c
+
+  Options:
+  -m <KiB>	size of the RAM (default 1024)
+  -l <usecs>	latency added to every memory transaction (default 0)
+  -i <idcode>	JTAG IDCODE (default 0x200444b1, ARC EM Starter Kit)
+
+  Usage example:
+
+  socat TCP-LISTEN:7777,reuseaddr,fork EXEC:"./remote_bitbang_arc_model -m 4096"
+  openocd -f arc_model_bench.cfg
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ARC JTAG instructions, IR is 4 bits long */
+#define IR_LENGTH			4
+#define IR_CAPTURE			0x1
+#define IR_STATUS			0x8
+#define IR_TRANSACTION		0x9
+#define IR_ADDRESS			0xA
+#define IR_DATA				0xB
+#define IR_IDCODE			0xC
+#define IR_BYPASS			0xF
+
+/* JTAG status register */
+#define STAT_READY			0x04
+#define STAT_RUNNING		0x10
+
+/* transactions */
+#define WRITE_TO_MEMORY		0x0
+#define WRITE_TO_CORE_REG	0x1
+#define WRITE_TO_AUX_REG	0x2
+#define CMD_NOP				0x3
+#define READ_FROM_MEMORY	0x4
+#define READ_FROM_CORE_REG	0x5
+#define READ_FROM_AUX_REG	0x6
+
+/* auxiliary registers */
+#define AUX_IDENTITY		0x4
+#define AUX_DEBUG			0x5
+#define AUX_PC				0x6
+#define AUX_STATUS32		0xA
+#define NUM_AUX_REGS		0x1000
+#define NUM_CORE_REGS		64
+
+#define DEBUG_FH			(1u << 1)
+#define DEBUG_IS			(1u << 11)
+#define STATUS32_H			(1u << 0)
+
+enum tap_state {
+	TEST_LOGIC_RESET, RUN_TEST_IDLE,
+	SELECT_DR, CAPTURE_DR, SHIFT_DR, EXIT1_DR, PAUSE_DR, EXIT2_DR, UPDATE_DR,
+	SELECT_IR, CAPTURE_IR, SHIFT_IR, EXIT1_IR, PAUSE_IR, EXIT2_IR, UPDATE_IR,
+};
+
+/* next state, indexed by current state and TMS */
+static const enum tap_state tap_next[16][2] = {
+	[TEST_LOGIC_RESET] = { RUN_TEST_IDLE, TEST_LOGIC_RESET },
+	[RUN_TEST_IDLE] = { RUN_TEST_IDLE, SELECT_DR },
+	[SELECT_DR] = { CAPTURE_DR, SELECT_IR },
+	[CAPTURE_DR] = { SHIFT_DR, EXIT1_DR },
+	[SHIFT_DR] = { SHIFT_DR, EXIT1_DR },
+	[EXIT1_DR] = { PAUSE_DR, UPDATE_DR },
+	[PAUSE_DR] = { PAUSE_DR, EXIT2_DR },
+	[EXIT2_DR] = { SHIFT_DR, UPDATE_DR },
+	[UPDATE_DR] = { RUN_TEST_IDLE, SELECT_DR },
+	[SELECT_IR] = { CAPTURE_IR, TEST_LOGIC_RESET },
+	[CAPTURE_IR] = { SHIFT_IR, EXIT1_IR },
+	[SHIFT_IR] = { SHIFT_IR, EXIT1_IR },
+	[EXIT1_IR] = { PAUSE_IR, UPDATE_IR },
+	[PAUSE_IR] = { PAUSE_IR, EXIT2_IR },
+	[EXIT2_IR] = { SHIFT_IR, UPDATE_IR },
+	[UPDATE_IR] = { RUN_TEST_IDLE, SELECT_DR },
+};
+
+static struct {
+	enum tap_state state;
+	bool tck;
+	uint32_t ir;
+	uint64_t shift;
+	unsigned int shift_len;
+	bool updated_dr;
+
+	uint32_t idcode;
+	uint32_t transaction;
+	uint32_t address;
+	uint32_t data;
+} tap;
+
+static struct {
+	bool running;
+	uint32_t core_regs[NUM_CORE_REGS];
+	uint32_t aux_regs[NUM_AUX_REGS];
+	uint8_t *ram;
+	uint32_t ram_size;
+	unsigned int latency_us;
+} core;
+
+static void core_reset(void)
+{
+	memset(core.core_regs, 0, sizeof(core.core_regs));
+	memset(core.aux_regs, 0, sizeof(core.aux_regs));
+	core.aux_regs[AUX_IDENTITY] = 0x00000042;	/* ARCv2 EM */
+	core.running = true;
+}
+
+static uint32_t core_read_aux(uint32_t addr)
+{
+	if (addr >= NUM_AUX_REGS)
+		return 0;
+	if (addr == AUX_STATUS32)
+		return core.aux_regs[addr] | (core.running ? 0 : STATUS32_H);
+	return core.aux_regs[addr];
+}
+
+static void core_write_aux(uint32_t addr, uint32_t value)
+{
+	if (addr >= NUM_AUX_REGS)
+		return;
+
+	switch (addr) {
+	case AUX_DEBUG:
+		if (value & DEBUG_FH)
+			core.running = false;
+		core.aux_regs[addr] = value & ~DEBUG_FH;
+		break;
+	case AUX_STATUS32:
+		core.aux_regs[addr] = value & ~STATUS32_H;
+		if (value & STATUS32_H)
+			break;
+		if (core.aux_regs[AUX_DEBUG] & DEBUG_IS) {
+			/* single step: "execute" one instruction and halt again */
+			core.aux_regs[AUX_PC] += 4;
+			core.running = false;
+		} else {
+			core.running = true;
+		}
+		break;
+	default:
+		core.aux_regs[addr] = value;
+	}
+}
+
+static uint32_t core_read_memory(uint32_t addr)
+{
+	uint32_t value = 0;
+
+	if (core.latency_us)
+		usleep(core.latency_us);
+	if (addr <= core.ram_size - 4)
+		memcpy(&value, core.ram + addr, 4);
+	return value;
+}
+
+static void core_write_memory(uint32_t addr, uint32_t value)
+{
+	if (core.latency_us)
+		usleep(core.latency_us);
+	if (addr <= core.ram_size - 4)
+		memcpy(core.ram + addr, &value, 4);
+}
+
+/* run the pending transaction when Run-Test/Idle is entered */
+static void tap_run_transaction(void)
+{
+	switch (tap.transaction) {
+	case WRITE_TO_MEMORY:
+		core_write_memory(tap.address, tap.data);
+		tap.address += 4;
+		break;
+	case READ_FROM_MEMORY:
+		tap.data = core_read_memory(tap.address);
+		tap.address += 4;
+		break;
+	case WRITE_TO_CORE_REG:
+		if (tap.address < NUM_CORE_REGS)
+			core.core_regs[tap.address] = tap.data;
+		tap.address++;
+		break;
+	case READ_FROM_CORE_REG:
+		tap.data = tap.address < NUM_CORE_REGS ? core.core_regs[tap.address] : 0;
+		tap.address++;
+		break;
+	case WRITE_TO_AUX_REG:
+		core_write_aux(tap.address, tap.data);
+		tap.address++;
+		break;
+	case READ_FROM_AUX_REG:
+		tap.data = core_read_aux(tap.address);
+		tap.address++;
+		break;
+	default:
+		break;
+	}
+}
+
+static void tap_capture_dr(void)
+{
+	switch (tap.ir) {
+	case IR_IDCODE:
+		tap.shift = tap.idcode;
+		tap.shift_len = 32;
+		break;
+	case IR_STATUS:
+		tap.shift = STAT_READY | (core.running ? STAT_RUNNING : 0);
+		tap.shift_len = 32;
+		break;
+	case IR_TRANSACTION:
+		tap.shift = tap.transaction;
+		tap.shift_len = 4;
+		break;
+	case IR_ADDRESS:
+		tap.shift = tap.address;
+		tap.shift_len = 32;
+		break;
+	case IR_DATA:
+		tap.shift = tap.data;
+		tap.shift_len = 32;
+		break;
+	default:
+		tap.shift = 0;
+		tap.shift_len = 1;
+	}
+}
+
+static void tap_update_dr(void)
+{
+	switch (tap.ir) {
+	case IR_TRANSACTION:
+		tap.transaction = tap.shift & 0xf;
+		break;
+	case IR_ADDRESS:
+		tap.address = tap.shift;
+		break;
+	case IR_DATA:
+		/* reads shift zeros in, only write transactions take the value */
+		if (tap.transaction < CMD_NOP)
+			tap.data = tap.shift;
+		break;
+	default:
+		return;
+	}
+	/* the transaction starts when the TAP next enters Run-Test/Idle */
+	tap.updated_dr = true;
+}
+
+static void tap_reset(void)
+{
+	tap.state = TEST_LOGIC_RESET;
+	tap.ir = IR_IDCODE;
+	tap.transaction = CMD_NOP;
+	tap.updated_dr = false;
+}
+
+/* rising edge of TCK */
+static void tap_clock(bool tms, bool tdi)
+{
+	enum tap_state prev = tap.state;
+
+	if (prev == SHIFT_DR || prev == SHIFT_IR)
+		tap.shift = (tap.shift >> 1) | ((uint64_t)tdi << (tap.shift_len - 1));
+
+	tap.state = tap_next[prev][tms];
+
+	switch (tap.state) {
+	case TEST_LOGIC_RESET:
+		tap_reset();
+		break;
+	case RUN_TEST_IDLE:
+		if (tap.updated_dr)
+			tap_run_transaction();
+		tap.updated_dr = false;
+		break;
+	case CAPTURE_DR:
+		tap_capture_dr();
+		break;
+	case UPDATE_DR:
+		tap_update_dr();
+		break;
+	case CAPTURE_IR:
+		tap.shift = IR_CAPTURE;
+		tap.shift_len = IR_LENGTH;
+		break;
+	case UPDATE_IR:
+		tap.ir = tap.shift & ((1u << IR_LENGTH) - 1);
+		break;
+	default:
+		break;
+	}
+}
+
+static bool tap_tdo(void)
+{
+	if (tap.state == SHIFT_DR || tap.state == SHIFT_IR)
+		return tap.shift & 1;
+	return false;
+}
+
+static uint8_t out_buf[4096];
+static size_t out_len;
+
+static void flush_output(void)
+{
+	size_t done = 0;
+
+	while (done < out_len) {
+		ssize_t n = write(STDOUT_FILENO, out_buf + done, out_len - done);
+		if (n <= 0)
+			exit(1);
+		done += n;
+	}
+	out_len = 0;
+}
+
+static void put_output(char c)
+{
+	if (out_len == sizeof(out_buf))
+		flush_output();
+	out_buf[out_len++] = c;
+}
+
+static void serve(void)
+{
+	uint8_t in_buf[4096];
+
+	for (;;) {
+		/* answer everything read so far before waiting for more input */
+		flush_output();
+
+		ssize_t n = read(STDIN_FILENO, in_buf, sizeof(in_buf));
+		if (n <= 0)
+			return;
+
+		for (ssize_t i = 0; i < n; i++) {
+			char c = in_buf[i];
+
+			switch (c) {
+			case '0' ... '7': {
+				bool tck = c & 4;
+				if (tck && !tap.tck)
+					tap_clock(c & 2, c & 1);
+				tap.tck = tck;
+				break;
+			}
+			case 'R':
+				put_output(tap_tdo() ? '1' : '0');
+				break;
+			case 'r' ... 'u':
+				/* trst is bit 1, srst is bit 0 */
+				if ((c - 'r') & 2)
+					tap_reset();
+				if ((c - 'r') & 1)
+					core_reset();
+				break;
+			case 'Q':
+				return;
+			default:
+				/* blink and unknown commands */
+				break;
+			}
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long ram_kib = 1024;
+	int opt;
+
+	tap.idcode = 0x200444b1;
+
+	while ((opt = getopt(argc, argv, "m:l:i:")) != -1) {
+		switch (opt) {
+		case 'm':
+			ram_kib = strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			core.latency_us = strtoul(optarg, NULL, 0);
+			break;
+		case 'i':
+			tap.idcode = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-m ram_kib] [-l latency_us] [-i idcode]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (ram_kib == 0 || ram_kib > 1024 * 1024) {
+		fprintf(stderr, "RAM size out of range\n");
+		return 1;
+	}
+	core.ram_size = ram_kib * 1024;
+	core.ram = calloc(core.ram_size, 1);
+	if (!core.ram) {
+		fprintf(stderr, "not enough memory\n");
+		return 1;
+	}
+
+	tap_reset();
+	core_reset();
+	serve();
+
+	free(core.ram);
+	return 0;
+}
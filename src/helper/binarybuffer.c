@@ -40,6 +40,20 @@ static const char hex_digits[] = {
 	'a', 'b', 'c', 'd', 'e', 'f'
 };
 
+/* value + 1 of each ASCII hex digit, 0 for all other characters */
+static const uint8_t hex_digit_values[256] = {
+	['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5,
+	['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+	['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+	['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+};
+
+/* value of an ASCII hex digit, or -1 if @c c is not a hex digit */
+static inline int hex_digit_value(char c)
+{
+	return hex_digit_values[(unsigned char)c] - 1;
+}
+
 void *buf_cpy(const void *from, void *_to, unsigned size)
 {
 	if (!from || !_to)
@@ -118,46 +132,74 @@ void *buf_set_ones(void *_buf, unsigned size)
 	return buf;
 }
 
+/* Load @c num (at most 57) bits starting at bit @c shift (0-7) of @c buf.
+ * Only the bytes that actually hold these bits are accessed. */
+static inline uint64_t buf_load_bits(const uint8_t *buf, unsigned shift, unsigned num)
+{
+	unsigned bytes = DIV_ROUND_UP(shift + num, 8);
+	uint64_t word = 0;
+
+	for (unsigned i = 0; i < bytes; i++)
+		word |= (uint64_t)buf[i] << (8 * i);
+
+	return (word >> shift) & (((uint64_t)1 << num) - 1);
+}
+
+/* Store @c num (at most 57) bits of @c value at bit @c shift (0-7) of @c buf,
+ * preserving the surrounding bits of the first and last byte. */
+static inline void buf_store_bits(uint8_t *buf, unsigned shift, unsigned num, uint64_t value)
+{
+	unsigned bytes = DIV_ROUND_UP(shift + num, 8);
+	uint64_t mask = (((uint64_t)1 << num) - 1) << shift;
+	uint64_t word = 0;
+
+	if (shift)
+		word |= buf[0];
+	if ((shift + num) % 8)
+		word |= (uint64_t)buf[bytes - 1] << (8 * (bytes - 1));
+
+	word = (word & ~mask) | ((value << shift) & mask);
+
+	for (unsigned i = 0; i < bytes; i++)
+		buf[i] = word >> (8 * i);
+}
+
 void *buf_set_buf(const void *_src, unsigned src_start,
 	void *_dst, unsigned dst_start, unsigned len)
 {
 	const uint8_t *src = _src;
 	uint8_t *dst = _dst;
-	unsigned i, sb, db, sq, dq, lb, lq;
+	unsigned sq, dq, lb, lq;
 
-	sb = src_start / 8;
-	db = dst_start / 8;
+	src += src_start / 8;
+	dst += dst_start / 8;
 	sq = src_start % 8;
 	dq = dst_start % 8;
 	lb = len / 8;
 	lq = len % 8;
 
-	src += sb;
-	dst += db;
-
-	/* check if both buffers are on byte boundary and
-	 * len is a multiple of 8bit so we can simple copy
-	 * the buffer */
-	if ((sq == 0) && (dq == 0) &&  (lq == 0)) {
-		for (i = 0; i < lb; i++)
-			*dst++ = *src++;
+	/* if both buffers are on byte boundary we can simply copy
+	 * the whole bytes and only merge the trailing bits */
+	if ((sq == 0) && (dq == 0)) {
+		memcpy(dst, src, lb);
+		if (lq)
+			buf_store_bits(dst + lb, 0, lq, buf_load_bits(src + lb, 0, lq));
 		return _dst;
 	}
 
-	/* fallback to slow bit copy */
-	for (i = 0; i < len; i++) {
-		if (((*src >> (sq&7)) & 1) == 1)
-			*dst |= 1 << (dq&7);
-		else
-			*dst &= ~(1 << (dq&7));
-		if (sq++ == 7) {
-			sq = 0;
-			src++;
-		}
-		if (dq++ == 7) {
-			dq = 0;
-			dst++;
-		}
+	/* unaligned copy, shift and mask up to 56 bits at a time */
+	while (len) {
+		unsigned chunk = MIN(len, 56u);
+
+		buf_store_bits(dst, dq, chunk, buf_load_bits(src, sq, chunk));
+
+		sq += chunk;
+		dq += chunk;
+		src += sq / 8;
+		dst += dq / 8;
+		sq %= 8;
+		dq %= 8;
+		len -= chunk;
 	}
 
 	return _dst;
@@ -354,27 +396,26 @@ void bit_copy_discard(struct bit_copy_queue *q)
 size_t unhexify(uint8_t *bin, const char *hex, size_t count)
 {
 	size_t i;
-	char tmp;
 
 	if (!bin || !hex)
 		return 0;
 
-	memset(bin, 0, count);
-
-	for (i = 0; i < 2 * count; i++) {
-		if (hex[i] >= 'a' && hex[i] <= 'f')
-			tmp = hex[i] - 'a' + 10;
-		else if (hex[i] >= 'A' && hex[i] <= 'F')
-			tmp = hex[i] - 'A' + 10;
-		else if (hex[i] >= '0' && hex[i] <= '9')
-			tmp = hex[i] - '0';
-		else
-			return i / 2;
-
-		bin[i / 2] |= tmp << (4 * ((i + 1) % 2));
+	for (i = 0; i < count; i++) {
+		int hi = hex_digit_value(hex[2 * i]);
+		if (hi < 0)
+			break;
+		int lo = hex_digit_value(hex[2 * i + 1]);
+		if (lo < 0) {
+			bin[i] = hi << 4;
+			memset(&bin[i + 1], 0, count - i - 1);
+			return i;
+		}
+		bin[i] = (hi << 4) | lo;
 	}
 
-	return i / 2;
+	memset(&bin[i], 0, count - i);
+
+	return i;
 }
 
 /**
@@ -392,14 +433,20 @@ size_t unhexify(uint8_t *bin, const char *hex, size_t count)
 size_t hexify(char *hex, const uint8_t *bin, size_t count, size_t length)
 {
 	size_t i;
-	uint8_t tmp;
 
 	if (!length)
 		return 0;
 
-	for (i = 0; i < length - 1 && i < 2 * count; i++) {
-		tmp = (bin[i / 2] >> (4 * ((i + 1) % 2))) & 0x0f;
-		hex[i] = hex_digits[tmp];
+	size_t chars = MIN(length - 1, 2 * count);
+
+	/* emit whole bytes first, then a possible odd high nibble */
+	for (i = 0; i + 1 < chars; i += 2) {
+		hex[i] = hex_digits[bin[i / 2] >> 4];
+		hex[i + 1] = hex_digits[bin[i / 2] & 0x0f];
+	}
+	if (i < chars) {
+		hex[i] = hex_digits[bin[i / 2] >> 4];
+		i++;
 	}
 
 	hex[i] = 0;
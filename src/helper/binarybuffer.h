@@ -38,11 +38,17 @@ static inline void buf_set_u32(uint8_t *_buffer,
 		buffer[1] = (value >> 8) & 0xff;
 		buffer[0] = (value >> 0) & 0xff;
 	} else {
-		for (unsigned i = first; i < first + num; i++) {
-			if (((value >> (i - first)) & 1) == 1)
-				buffer[i / 8] |= 1 << (i % 8);
-			else
-				buffer[i / 8] &= ~(1 << (i % 8));
+		/* insert the field one (partial) byte at a time */
+		unsigned i = first;
+		while (i < first + num) {
+			unsigned shift = i % 8;
+			unsigned bits = first + num - i;
+			if (bits > 8 - shift)
+				bits = 8 - shift;
+			uint8_t mask = ((1U << bits) - 1) << shift;
+			buffer[i / 8] = (buffer[i / 8] & ~mask) |
+				(((value >> (i - first)) << shift) & mask);
+			i += bits;
 		}
 	}
 }
@@ -77,11 +83,17 @@ static inline void buf_set_u64(uint8_t *_buffer,
 		buffer[1] = (value >> 8) & 0xff;
 		buffer[0] = (value >> 0) & 0xff;
 	} else {
-		for (unsigned i = first; i < first + num; i++) {
-			if (((value >> (i - first)) & 1) == 1)
-				buffer[i / 8] |= 1 << (i % 8);
-			else
-				buffer[i / 8] &= ~(1 << (i % 8));
+		/* insert the field one (partial) byte at a time */
+		unsigned i = first;
+		while (i < first + num) {
+			unsigned shift = i % 8;
+			unsigned bits = first + num - i;
+			if (bits > 8 - shift)
+				bits = 8 - shift;
+			uint8_t mask = ((1U << bits) - 1) << shift;
+			buffer[i / 8] = (buffer[i / 8] & ~mask) |
+				(((value >> (i - first)) << shift) & mask);
+			i += bits;
 		}
 	}
 }
@@ -106,10 +118,16 @@ static inline uint32_t buf_get_u32(const uint8_t *_buffer,
 				(((uint32_t)buffer[1]) << 8) |
 				(((uint32_t)buffer[0]) << 0);
 	} else {
+		/* extract the field one (partial) byte at a time */
 		uint32_t result = 0;
-		for (unsigned i = first; i < first + num; i++) {
-			if (((buffer[i / 8] >> (i % 8)) & 1) == 1)
-				result |= 1U << (i - first);
+		unsigned i = first;
+		while (i < first + num) {
+			unsigned shift = i % 8;
+			unsigned bits = first + num - i;
+			if (bits > 8 - shift)
+				bits = 8 - shift;
+			result |= (uint32_t)((buffer[i / 8] >> shift) & ((1U << bits) - 1)) << (i - first);
+			i += bits;
 		}
 		return result;
 	}
@@ -144,10 +162,16 @@ static inline uint64_t buf_get_u64(const uint8_t *_buffer,
 				(((uint64_t)buffer[1]) << 8)  |
 				(((uint64_t)buffer[0]) << 0));
 	} else {
+		/* extract the field one (partial) byte at a time */
 		uint64_t result = 0;
-		for (unsigned i = first; i < first + num; i++) {
-			if (((buffer[i / 8] >> (i % 8)) & 1) == 1)
-				result = result | ((uint64_t)1 << (uint64_t)(i - first));
+		unsigned i = first;
+		while (i < first + num) {
+			unsigned shift = i % 8;
+			unsigned bits = first + num - i;
+			if (bits > 8 - shift)
+				bits = 8 - shift;
+			result |= (uint64_t)((buffer[i / 8] >> shift) & ((1U << bits) - 1)) << (i - first);
+			i += bits;
 		}
 		return result;
 	}
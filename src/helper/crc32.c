@@ -13,38 +13,106 @@
 #endif
 
 #include "crc32.h"
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
-static uint32_t crc_le_step(uint32_t poly, uint32_t crc, uint32_t data_in,
-		unsigned int data_bits)
+/*
+ * Slice-by-8: table[0] is the classic byte at a time table, table[k] advances
+ * a byte through k more zero bytes, so eight input bytes are processed with
+ * eight independent lookups. Tables are built on first use for the last
+ * polynomial requested in each bit order.
+ */
+struct crc32_tables {
+	bool valid;
+	uint32_t poly;
+	uint32_t table[8][256];
+};
+
+static const uint32_t (*crc32_le_tables(uint32_t poly))[256]
 {
-	for (unsigned int i = 0; i < data_bits; i++) {
-		uint32_t d, c;
-		d = ((data_in >> i) & 0x1) ? 0xffffffff : 0;
-		c = (crc & 0x1) ? 0xffffffff : 0;
-		crc = crc >> 1;
-		crc = crc ^ ((d ^ c) & poly);
+	static struct crc32_tables t;
+
+	if (t.valid && t.poly == poly)
+		return t.table;
+
+	for (unsigned int i = 0; i < 256; i++) {
+		uint32_t c = i;
+		for (unsigned int j = 0; j < 8; j++)
+			c = (c & 1) ? (c >> 1) ^ poly : c >> 1;
+		t.table[0][i] = c;
 	}
+	for (unsigned int k = 1; k < 8; k++)
+		for (unsigned int i = 0; i < 256; i++)
+			t.table[k][i] = (t.table[k - 1][i] >> 8) ^ t.table[0][t.table[k - 1][i] & 0xff];
 
-	return crc;
+	t.poly = poly;
+	t.valid = true;
+	return t.table;
+}
+
+static const uint32_t (*crc32_be_tables(uint32_t poly))[256]
+{
+	static struct crc32_tables t;
+
+	if (t.valid && t.poly == poly)
+		return t.table;
+
+	for (unsigned int i = 0; i < 256; i++) {
+		uint32_t c = i << 24;
+		for (unsigned int j = 0; j < 8; j++)
+			c = (c & 0x80000000) ? (c << 1) ^ poly : c << 1;
+		t.table[0][i] = c;
+	}
+	for (unsigned int k = 1; k < 8; k++)
+		for (unsigned int i = 0; i < 256; i++)
+			t.table[k][i] = (t.table[k - 1][i] << 8) ^ t.table[0][t.table[k - 1][i] >> 24];
+
+	t.poly = poly;
+	t.valid = true;
+	return t.table;
 }
 
 uint32_t crc32_le(uint32_t poly, uint32_t seed, const void *_data,
 		size_t data_len)
 {
-	if (((uintptr_t)_data & 0x3) || (data_len & 0x3)) {
-		/* data is unaligned, processing data one byte at a time */
-		const uint8_t *data = _data;
-		for (size_t i = 0; i < data_len; i++)
-			seed = crc_le_step(poly, seed, data[i], 8);
-	} else {
-		/* data is aligned, processing 32 bit at a time */
-		data_len >>= 2;
-		const uint32_t *data = _data;
-		for (size_t i = 0; i < data_len; i++)
-			seed = crc_le_step(poly, seed, data[i], 32);
+	const uint32_t (*t)[256] = crc32_le_tables(poly);
+	const uint8_t *data = _data;
+	uint32_t crc = seed;
+
+	for (; data_len >= 8; data_len -= 8, data += 8) {
+		uint32_t lo = crc ^ (data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24);
+		uint32_t hi = data[4] | data[5] << 8 | data[6] << 16 | (uint32_t)data[7] << 24;
+		crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+			t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+			t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^
+			t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
 	}
 
-	return seed;
+	while (data_len--)
+		crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xff];
+
+	return crc;
+}
+
+uint32_t crc32_be(uint32_t poly, uint32_t seed, const void *_data,
+		size_t data_len)
+{
+	const uint32_t (*t)[256] = crc32_be_tables(poly);
+	const uint8_t *data = _data;
+	uint32_t crc = seed;
+
+	for (; data_len >= 8; data_len -= 8, data += 8) {
+		uint32_t hi = crc ^ ((uint32_t)data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3]);
+		uint32_t lo = (uint32_t)data[4] << 24 | data[5] << 16 | data[6] << 8 | data[7];
+		crc = t[7][hi >> 24] ^ t[6][(hi >> 16) & 0xff] ^
+			t[5][(hi >> 8) & 0xff] ^ t[4][hi & 0xff] ^
+			t[3][lo >> 24] ^ t[2][(lo >> 16) & 0xff] ^
+			t[1][(lo >> 8) & 0xff] ^ t[0][lo & 0xff];
+	}
+
+	while (data_len--)
+		crc = (crc << 8) ^ t[0][((crc >> 24) ^ *data++) & 0xff];
+
+	return crc;
 }
@@ -20,6 +20,12 @@
  */
 #define CRC32_POLY_LE	0xedb88320
 
+/**
+ * CRC32 polynomial in normal (MSB first) representation, as used by GDB's
+ * "compare-sections" and the target checksum_memory algorithms
+ */
+#define CRC32_POLY_BE	0x04c11db7
+
 /**
  * Calculate the CRC32 value of the given data
  * @param	poly		The polynomial of the CRC
@@ -34,4 +40,17 @@
 uint32_t crc32_le(uint32_t poly, uint32_t seed, const void *data,
 		size_t data_len);
 
+/**
+ * Calculate the CRC32 value of the given data, processing the bits of each
+ * byte MSB first
+ * @param	poly		The polynomial of the CRC, e.g. @ref CRC32_POLY_BE
+ * @param	seed		The seed to use (mostly either `0` or `0xffffffff`)
+ * @param	data		The data to calculate the CRC32 of
+ * @param	data_len	The length of the data in @p data in bytes
+ * @return	The CRC value of the first @p data_len bytes at @p data
+ * @note	Like crc32_le(), this can be used incrementally.
+ */
+uint32_t crc32_be(uint32_t poly, uint32_t seed, const void *data,
+		size_t data_len);
+
 #endif /* OPENOCD_HELPER_CRC32_H */
@@ -20,16 +20,26 @@
 #include "fileio.h"
 #include "replacements.h"
 
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
 struct fileio {
 	char *url;
 	size_t size;
 	enum fileio_type type;
 	enum fileio_access access;
 	FILE *file;
+	void *map;		/* see fileio_map() */
 };
 
 static inline int fileio_close_local(struct fileio *fileio)
 {
+#ifdef HAVE_SYS_MMAN_H
+	if (fileio->map)
+		munmap(fileio->map, fileio->size);
+#endif
+
 	int retval = fclose(fileio->file);
 	if (retval != 0) {
 		if (retval == EBADF)
@@ -112,7 +122,7 @@ int fileio_open(struct fileio **fileio, const char *url,
 	int retval;
 	struct fileio *tmp;
 
-	tmp = malloc(sizeof(struct fileio));
+	tmp = calloc(1, sizeof(struct fileio));
 
 	tmp->type = type;
 	tmp->access = access_type;
@@ -262,3 +272,53 @@ int fileio_size(struct fileio *fileio, size_t *size)
 
 	return ERROR_OK;
 }
+
+/**
+ * Map the whole of a file opened for reading into memory, read-only.
+ * The mapping stays valid until the file is closed.
+ *
+ * The mapping is private, but still backed by the file: if the file is
+ * truncated while it is open, accessing the lost part raises SIGBUS.
+ * Callers check fileio_map_check() before each use of the mapping, which
+ * narrows, but can't close, that window.
+ * @returns ERROR_FILEIO_OPERATION_NOT_SUPPORTED if the host or the file
+ * (e.g. empty, or not a regular file) does not support it, the caller
+ * has to use fileio_read() instead.
+ */
+int fileio_map(struct fileio *fileio, const void **data)
+{
+#ifdef HAVE_SYS_MMAN_H
+	if (!fileio->map) {
+		if (fileio->access != FILEIO_READ || fileio->type != FILEIO_BINARY || fileio->size == 0)
+			return ERROR_FILEIO_OPERATION_NOT_SUPPORTED;
+
+		void *map = mmap(NULL, fileio->size, PROT_READ, MAP_PRIVATE, fileno(fileio->file), 0);
+		if (map == MAP_FAILED) {
+			LOG_DEBUG("couldn't map %s: %s", fileio->url, strerror(errno));
+			return ERROR_FILEIO_OPERATION_NOT_SUPPORTED;
+		}
+		fileio->map = map;
+	}
+
+	*data = fileio->map;
+	return ERROR_OK;
+#else
+	return ERROR_FILEIO_OPERATION_NOT_SUPPORTED;
+#endif
+}
+
+/**
+ * Check that a file mapped by fileio_map() still has the size it was
+ * mapped with, i.e. that it has not been truncated since.
+ */
+int fileio_map_check(struct fileio *fileio)
+{
+	struct stat st;
+
+	if (fstat(fileno(fileio->file), &st) != 0 || (uint64_t)st.st_size < fileio->size) {
+		LOG_ERROR("%s changed while in use", fileio->url);
+		return ERROR_FILEIO_OPERATION_FAILED;
+	}
+
+	return ERROR_OK;
+}
@@ -52,6 +52,48 @@ static const char * const log_strings[6] = {
 
 static int count;
 
+/* With "log_output -buffered" the log file is not flushed after every
+ * message, only on errors, when the server loop goes idle and at least
+ * every LOG_FLUSH_INTERVAL_MS. */
+#define LOG_BUFFER_SIZE			(64 * 1024)
+#define LOG_FLUSH_INTERVAL_MS	100
+static bool log_buffered;
+static int64_t log_last_flush;
+
+/* messages shorter than this are formatted without a heap allocation */
+#define LOG_STACK_BUFFER_SIZE	256
+
+static void log_output_flush(enum log_levels level)
+{
+	if (log_buffered && level != LOG_LVL_ERROR) {
+		int64_t now = timeval_ms();
+		if (now - log_last_flush < LOG_FLUSH_INTERVAL_MS)
+			return;
+		log_last_flush = now;
+	}
+
+	fflush(log_output);
+}
+
+/* Format into @a buf, or into an allocated string when it does not fit;
+ * the result always has room for one more character. */
+static char *log_vformat(char *buf, size_t size, const char *format, va_list ap)
+{
+	va_list ap_copy;
+	int len;
+
+	va_copy(ap_copy, ap);
+	len = vsnprintf(buf, size - 1, format, ap_copy);
+	va_end(ap_copy);
+
+	if (len < 0)
+		return NULL;
+	if ((size_t)len < size - 1)
+		return buf;
+
+	return alloc_vprintf(format, ap);
+}
+
 /* forward the log to the listeners */
 static void log_forward(const char *file, unsigned line, const char *function, const char *string)
 {
@@ -93,7 +135,7 @@ static void log_puts(enum log_levels level,
 	if (level == LOG_LVL_OUTPUT) {
 		/* do not prepend any headers, just print out what we were given and return */
 		fputs(string, log_output);
-		fflush(log_output);
+		log_output_flush(level);
 		return;
 	}
 
@@ -124,7 +166,7 @@ static void log_puts(enum log_levels level,
 			(level > LOG_LVL_USER) ? log_strings[level + 1] : "", string);
 	}
 
-	fflush(log_output);
+	log_output_flush(level);
 
 	/* Never forward LOG_LVL_DEBUG, too verbose and they can be found in the log if need be */
 	if (level <= LOG_LVL_INFO)
@@ -138,6 +180,7 @@ void log_printf(enum log_levels level,
 	const char *format,
 	...)
 {
+	char buf[LOG_STACK_BUFFER_SIZE];
 	char *string;
 	va_list ap;
 
@@ -147,10 +190,11 @@ void log_printf(enum log_levels level,
 
 	va_start(ap, format);
 
-	string = alloc_vprintf(format, ap);
+	string = log_vformat(buf, sizeof(buf), format, ap);
 	if (string) {
 		log_puts(level, file, line, function, string);
-		free(string);
+		if (string != buf)
+			free(string);
 	}
 
 	va_end(ap);
@@ -159,6 +203,7 @@ void log_printf(enum log_levels level,
 void log_vprintf_lf(enum log_levels level, const char *file, unsigned line,
 		const char *function, const char *format, va_list args)
 {
+	char buf[LOG_STACK_BUFFER_SIZE];
 	char *tmp;
 
 	count++;
@@ -166,18 +211,19 @@ void log_vprintf_lf(enum log_levels level, const char *file, unsigned line,
 	if (level > debug_level)
 		return;
 
-	tmp = alloc_vprintf(format, args);
+	tmp = log_vformat(buf, sizeof(buf), format, args);
 
 	if (!tmp)
 		return;
 
 	/*
-	 * Note: alloc_vprintf() guarantees that the buffer is at least one
+	 * Note: log_vformat() guarantees that the buffer is at least one
 	 * character longer.
 	 */
 	strcat(tmp, "\n");
 	log_puts(level, file, line, function, tmp);
-	free(tmp);
+	if (tmp != buf)
+		free(tmp);
 }
 
 void log_printf_lf(enum log_levels level,
@@ -214,12 +260,21 @@ COMMAND_HANDLER(handle_debug_level_command)
 
 COMMAND_HANDLER(handle_log_output_command)
 {
+	bool buffered = false;
+
+	if (CMD_ARGC > 0 && strcmp(CMD_ARGV[0], "-buffered") == 0) {
+		buffered = true;
+		CMD_ARGC--;
+		CMD_ARGV++;
+	}
+
 	if (CMD_ARGC == 0 || (CMD_ARGC == 1 && strcmp(CMD_ARGV[0], "default") == 0)) {
 		if (log_output != stderr && log_output) {
 			/* Close previous log file, if it was open and wasn't stderr. */
 			fclose(log_output);
 		}
 		log_output = stderr;
+		log_buffered = false;
 		LOG_DEBUG("set log_output to default");
 		return ERROR_OK;
 	}
@@ -233,7 +288,10 @@ COMMAND_HANDLER(handle_log_output_command)
 			/* Close previous log file, if it was open and wasn't stderr. */
 			fclose(log_output);
 		}
+		if (buffered)
+			setvbuf(file, NULL, _IOFBF, LOG_BUFFER_SIZE);
 		log_output = file;
+		log_buffered = buffered;
 		LOG_DEBUG("set log_output to \"%s\"", CMD_ARGV[0]);
 		return ERROR_OK;
 	}
@@ -246,8 +304,9 @@ static const struct command_registration log_command_handlers[] = {
 		.name = "log_output",
 		.handler = handle_log_output_command,
 		.mode = COMMAND_ANY,
-		.help = "redirect logging to a file (default: stderr)",
-		.usage = "[file_name | \"default\"]",
+		.help = "redirect logging to a file (default: stderr), "
+			"optionally flushing the file only periodically",
+		.usage = "['-buffered'] [file_name | \"default\"]",
 	},
 	{
 		.name = "debug_level",
@@ -287,6 +346,14 @@ void log_init(void)
 	start = last_time = timeval_ms();
 }
 
+/* write out what a buffered log file still holds */
+void log_flush(void)
+{
+	if (log_output)
+		fflush(log_output);
+	log_last_flush = timeval_ms();
+}
+
 void log_exit(void)
 {
 	if (log_output && log_output != stderr) {
@@ -294,6 +361,7 @@ void log_exit(void)
 		fclose(log_output);
 	}
 	log_output = NULL;
+	log_buffered = false;
 }
 
 /* add/remove log callback handler */
@@ -150,18 +150,11 @@ static int lattice_certus_exit_programming_mode(struct jtag_tap *tap)
 
 static int lattice_certus_program_config_map(struct jtag_tap *tap, struct lattice_bit_file *bit_file)
 {
-	struct scan_field field;
-
 	int retval = lattice_set_instr(tap, LSC_BITSTREAM_BURST, TAP_IDLE);
 	if (retval != ERROR_OK)
 		return retval;
 
-	field.num_bits = (bit_file->raw_bit.length - bit_file->offset) * 8;
-	field.out_value = bit_file->raw_bit.data + bit_file->offset;
-	field.in_value = NULL;
-	jtag_add_dr_scan(tap, 1, &field, TAP_IDLE);
-
-	return jtag_execute_queue();
+	return cpld_scan_raw_bit_stream(tap, &bit_file->stream, 0, TAP_IDLE);
 }
 
 int lattice_certus_load(struct lattice_pld_device *lattice_device, struct lattice_bit_file *bit_file)
@@ -130,11 +130,9 @@ static int lattice_ecp5_program_config_map(struct jtag_tap *tap, struct lattice_
 	jtag_add_runtest(2, TAP_IDLE);
 	jtag_add_sleep(10000);
 
-	struct scan_field field;
-	field.num_bits = (bit_file->raw_bit.length - bit_file->offset) * 8;
-	field.out_value = bit_file->raw_bit.data + bit_file->offset;
-	field.in_value = NULL;
-	jtag_add_dr_scan(tap, 1, &field, TAP_IDLE);
+	retval = cpld_scan_raw_bit_stream(tap, &bit_file->stream, 0, TAP_IDLE);
+	if (retval != ERROR_OK)
+		return retval;
 	retval = lattice_set_instr(tap, BYPASS, TAP_IDLE);
 	if (retval != ERROR_OK)
 		return retval;
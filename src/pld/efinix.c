@@ -41,65 +41,9 @@ struct efinix_pld_device {
 	enum efinix_family_e family;
 };
 
-static int efinix_read_bit_file(struct raw_bit_file *bit_file, const char *filename)
+static int efinix_open_file(struct raw_bit_stream *stream, const char *filename)
 {
-	FILE *input_file = fopen(filename, "r");
-	if (!input_file) {
-		LOG_ERROR("couldn't open %s: %s", filename, strerror(errno));
-		return ERROR_PLD_FILE_LOAD_FAILED;
-	}
-
-	fseek(input_file, 0, SEEK_END);
-	long length = ftell(input_file);
-	fseek(input_file, 0, SEEK_SET);
-
-	if (length < 0 || ((length % 3))) {
-		fclose(input_file);
-		LOG_ERROR("Failed to get length from file %s: %s", filename, strerror(errno));
-		return ERROR_PLD_FILE_LOAD_FAILED;
-	}
-	bit_file->length = DIV_ROUND_UP(length, 3);
-
-	bit_file->data = malloc(bit_file->length);
-	if (!bit_file->data) {
-		fclose(input_file);
-		LOG_ERROR("Out of memory");
-		return ERROR_PLD_FILE_LOAD_FAILED;
-	}
-
-	bool end_detected = false;
-	char buffer[3];
-	for (size_t idx = 0; !end_detected && idx < bit_file->length; ++idx) {
-		size_t read_count = fread(buffer, sizeof(char), 3, input_file);
-		end_detected = feof(input_file);
-		if ((read_count == 3 && buffer[2] != '\n') ||
-			(read_count != 3 && !end_detected) ||
-			(read_count != 2 && end_detected)) {
-			fclose(input_file);
-			free(bit_file->data);
-			bit_file->data = NULL;
-			LOG_ERROR("unexpected line length");
-			return ERROR_PLD_FILE_LOAD_FAILED;
-		}
-
-		if (!isxdigit(buffer[0]) || !isxdigit(buffer[1])) {
-			fclose(input_file);
-			free(bit_file->data);
-			bit_file->data = NULL;
-			LOG_ERROR("unexpected char in hex string");
-			return ERROR_PLD_FILE_LOAD_FAILED;
-		}
-		unhexify(&bit_file->data[idx], buffer, 2);
-	}
-
-	fclose(input_file);
-
-	return ERROR_OK;
-}
-
-static int efinix_read_file(struct raw_bit_file *bit_file, const char *filename)
-{
-	if (!filename || !bit_file)
+	if (!filename || !stream)
 		return ERROR_COMMAND_SYNTAX_ERROR;
 
 	/* check if binary .bin or ascii .bit/.hex */
@@ -110,10 +54,10 @@ static int efinix_read_file(struct raw_bit_file *bit_file, const char *filename)
 	}
 
 	if (strcasecmp(file_ending_pos, ".bin") == 0) {
-		return cpld_read_raw_bit_file(bit_file, filename);
+		return cpld_open_raw_bit_stream(stream, filename, RAW_BIT_BINARY, 0);
 	} else if ((strcasecmp(file_ending_pos, ".bit") == 0) ||
 			(strcasecmp(file_ending_pos, ".hex") == 0)) {
-		return efinix_read_bit_file(bit_file, filename);
+		return cpld_open_raw_bit_stream(stream, filename, RAW_BIT_HEX, 0);
 	}
 
 	LOG_ERROR("Unable to detect filetype");
@@ -139,8 +83,7 @@ static int efinix_set_instr(struct jtag_tap *tap, uint8_t new_instr)
 
 static int efinix_load(struct pld_device *pld_device, const char *filename)
 {
-	struct raw_bit_file bit_file;
-	struct scan_field field[2];
+	struct raw_bit_stream stream;
 
 	if (!pld_device || !pld_device->driver_priv)
 		return ERROR_FAIL;
@@ -163,33 +106,14 @@ static int efinix_load(struct pld_device *pld_device, const char *filename)
 	if (retval != ERROR_OK)
 		return retval;
 
-	retval = efinix_read_file(&bit_file, filename);
+	retval = efinix_open_file(&stream, filename);
 	if (retval != ERROR_OK)
 		return retval;
 
-	for (size_t i = 0; i < bit_file.length; i++)
-		bit_file.data[i] = flip_u32(bit_file.data[i], 8);
-
-	/* shift in the bitstream */
-	field[0].num_bits = bit_file.length * 8;
-	field[0].out_value = bit_file.data;
-	field[0].in_value = NULL;
-
-	/* followed by zeros */
-	field[1].num_bits = TRAILING_ZEROS;
-	uint8_t *buf = calloc(TRAILING_ZEROS / 8, 1);
-	if (!buf) {
-		free(bit_file.data);
-		LOG_ERROR("Out of memory");
-		return ERROR_FAIL;
-	}
-	field[1].out_value = buf;
-	field[1].in_value = NULL;
-
-	jtag_add_dr_scan(tap, 2, field, TAP_DRPAUSE);
-	retval = jtag_execute_queue();
-	free(bit_file.data);
-	free(buf);
+	/* shift in the bitstream, followed by zeros */
+	stream.flip = true;
+	retval = cpld_scan_raw_bit_stream(tap, &stream, TRAILING_ZEROS, TAP_DRPAUSE);
+	cpld_close_raw_bit_stream(&stream);
 	if (retval != ERROR_OK)
 		return retval;
 
@@ -170,7 +170,12 @@ static int gowin_read_fs_file(struct gowin_bit_file *bit_file, const char *filen
 	return ERROR_OK;
 }
 
-static int gowin_read_file(struct gowin_bit_file *bit_file, const char *filename, bool *is_fs)
+/*
+ * .bin files are streamed from the file, .fs files are decoded into memory
+ * first as the header has to be parsed before loading.
+ */
+static int gowin_open_file(struct gowin_bit_file *bit_file, const char *filename,
+	bool *is_fs, struct raw_bit_stream *stream)
 {
 	memset(bit_file, 0, sizeof(struct gowin_bit_file));
 
@@ -186,16 +191,26 @@ static int gowin_read_file(struct gowin_bit_file *bit_file, const char *filename
 	/* check if binary .bin or ascii .fs */
 	if (strcasecmp(file_suffix_pos, ".bin") == 0) {
 		*is_fs = false;
-		return cpld_read_raw_bit_file(&bit_file->raw_file, filename);
+		return cpld_open_raw_bit_stream(stream, filename, RAW_BIT_BINARY, 0);
 	} else if (strcasecmp(file_suffix_pos, ".fs") == 0) {
 		*is_fs = true;
-		return gowin_read_fs_file(bit_file, filename);
+		int retval = gowin_read_fs_file(bit_file, filename);
+		if (retval != ERROR_OK)
+			return retval;
+		cpld_init_raw_bit_stream(stream, bit_file->raw_file.data, bit_file->raw_file.length);
+		return ERROR_OK;
 	}
 
 	LOG_ERROR("Filetype not supported, expecting .fs or .bin file");
 	return ERROR_PLD_FILE_LOAD_FAILED;
 }
 
+static void gowin_close_file(struct gowin_bit_file *bit_file, struct raw_bit_stream *stream)
+{
+	cpld_close_raw_bit_stream(stream);
+	free(bit_file->raw_file.data);
+}
+
 static int gowin_set_instr(struct jtag_tap *tap, uint8_t new_instr)
 {
 	struct scan_field field;
@@ -354,22 +369,21 @@ static int gowin_load_to_sram(struct pld_device *pld_device, const char *filenam
 
 	bool is_fs = false;
 	struct gowin_bit_file bit_file;
-	int retval = gowin_read_file(&bit_file, filename, &is_fs);
+	struct raw_bit_stream stream;
+	int retval = gowin_open_file(&bit_file, filename, &is_fs, &stream);
 	if (retval != ERROR_OK)
 		return retval;
-
-	for (unsigned int i = 0; i < bit_file.raw_file.length; i++)
-		bit_file.raw_file.data[i] = flip_u32(bit_file.raw_file.data[i], 8);
+	stream.flip = true;
 
 	uint32_t id;
 	retval = gowin_read_register(tap, IDCODE, &id);
 	if (retval != ERROR_OK) {
-		free(bit_file.raw_file.data);
+		gowin_close_file(&bit_file, &stream);
 		return retval;
 	}
 
 	if (is_fs && id != bit_file.id) {
-		free(bit_file.raw_file.data);
+		gowin_close_file(&bit_file, &stream);
 		LOG_ERROR("Id on device (0x%8.8" PRIx32 ") and id in bit-stream (0x%8.8" PRIx32 ") don't match.",
 			id, bit_file.id);
 		return ERROR_FAIL;
@@ -377,43 +391,38 @@ static int gowin_load_to_sram(struct pld_device *pld_device, const char *filenam
 
 	retval = gowin_enable_config(tap);
 	if (retval != ERROR_OK) {
-		free(bit_file.raw_file.data);
+		gowin_close_file(&bit_file, &stream);
 		return retval;
 	}
 
 	retval = gowin_erase_sram(tap, false);
 	if (retval != ERROR_OK) {
-		free(bit_file.raw_file.data);
+		gowin_close_file(&bit_file, &stream);
 		return retval;
 	}
 
 	retval = gowin_set_instr(tap, ADDRESS_INITIALIZATION);
 	if (retval != ERROR_OK) {
-		free(bit_file.raw_file.data);
+		gowin_close_file(&bit_file, &stream);
 		return retval;
 	}
 	retval = gowin_set_instr(tap, TRANSFER_CONFIGURATION_DATA);
 	if (retval != ERROR_OK) {
-		free(bit_file.raw_file.data);
+		gowin_close_file(&bit_file, &stream);
 		return retval;
 	}
 
 	/* scan out the bitstream */
-	struct scan_field field;
-	field.num_bits = bit_file.raw_file.length * 8;
-	field.out_value = bit_file.raw_file.data;
-	field.in_value = bit_file.raw_file.data;
-	jtag_add_dr_scan(gowin_info->tap, 1, &field, TAP_IDLE);
+	retval = cpld_scan_raw_bit_stream(gowin_info->tap, &stream, 0, TAP_IDLE);
+	gowin_close_file(&bit_file, &stream);
+	if (retval != ERROR_OK)
+		return retval;
 	jtag_add_runtest(3, TAP_IDLE);
-
 	retval = jtag_execute_queue();
-	if (retval != ERROR_OK) {
-		free(bit_file.raw_file.data);
+	if (retval != ERROR_OK)
 		return retval;
-	}
 
 	retval = gowin_disable_config(tap);
-	free(bit_file.raw_file.data);
 	if (retval != ERROR_OK)
 		return retval;
 
@@ -184,9 +184,9 @@ static int intel_check_config(struct intel_pld_device *intel_info)
 	return ERROR_OK;
 }
 
-static int intel_read_file(struct raw_bit_file *bit_file, const char *filename)
+static int intel_open_file(struct raw_bit_stream *stream, const char *filename)
 {
-	if (!filename || !bit_file)
+	if (!filename || !stream)
 		return ERROR_COMMAND_SYNTAX_ERROR;
 
 	/* check if binary .bin or ascii .bit/.hex */
@@ -197,7 +197,7 @@ static int intel_read_file(struct raw_bit_file *bit_file, const char *filename)
 	}
 
 	if (strcasecmp(file_ending_pos, ".rbf") == 0)
-		return cpld_read_raw_bit_file(bit_file, filename);
+		return cpld_open_raw_bit_stream(stream, filename, RAW_BIT_BINARY, 0);
 
 	LOG_ERROR("Unable to detect filetype");
 	return ERROR_PLD_FILE_LOAD_FAILED;
@@ -243,35 +243,26 @@ static int intel_load(struct pld_device *pld_device, const char *filename)
 	if (retval != ERROR_OK)
 		return retval;
 
-	struct raw_bit_file bit_file;
-	retval = intel_read_file(&bit_file, filename);
-	if (retval != ERROR_OK)
-		return retval;
-
+	struct raw_bit_stream stream;
+	retval = intel_open_file(&stream, filename);
 	if (retval != ERROR_OK)
 		return retval;
 
 	retval = intel_set_instr(tap, 0x002);
 	if (retval != ERROR_OK) {
-		free(bit_file.data);
+		cpld_close_raw_bit_stream(&stream);
 		return retval;
 	}
 	jtag_add_runtest(speed, TAP_IDLE);
 	retval = jtag_execute_queue();
 	if (retval != ERROR_OK) {
-		free(bit_file.data);
+		cpld_close_raw_bit_stream(&stream);
 		return retval;
 	}
 
 	/* shift in the bitstream */
-	struct scan_field field;
-	field.num_bits = bit_file.length * 8;
-	field.out_value = bit_file.data;
-	field.in_value = NULL;
-
-	jtag_add_dr_scan(tap, 1, &field, TAP_DRPAUSE);
-	retval = jtag_execute_queue();
-	free(bit_file.data);
+	retval = cpld_scan_raw_bit_stream(tap, &stream, 0, TAP_DRPAUSE);
+	cpld_close_raw_bit_stream(&stream);
 	if (retval != ERROR_OK)
 		return retval;
 
@@ -290,6 +281,7 @@ static int intel_load(struct pld_device *pld_device, const char *filename)
 			return ERROR_FAIL;
 		}
 
+		struct scan_field field;
 		field.num_bits = intel_info->boundary_scan_length;
 		field.out_value = buf;
 		field.in_value = buf;
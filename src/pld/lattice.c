@@ -315,7 +315,7 @@ static int lattice_load_command(struct pld_device *pld_device, const char *filen
 		LOG_ERROR("loading unknown device family");
 		break;
 	}
-	free(bit_file.raw_bit.data);
+	lattice_free_file(&bit_file);
 	return retval;
 }
 
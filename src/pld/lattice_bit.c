@@ -23,12 +23,11 @@ enum read_bit_state {
 	DONE,
 };
 
-static int lattice_read_bit_file(struct lattice_bit_file *bit_file, const char *filename, enum lattice_family_e family)
-{
-	int retval = cpld_read_raw_bit_file(&bit_file->raw_bit, filename);
-	if (retval != ERROR_OK)
-		return retval;
+/* the header and the device ID are expected within the first bytes of a .bit file */
+#define LATTICE_BIT_HEADER_SIZE_MAX	(64 * 1024)
 
+static int lattice_parse_bit_header(struct lattice_bit_file *bit_file, enum lattice_family_e family)
+{
 	bit_file->part = NULL;
 	bit_file->has_id = false;
 	enum read_bit_state state = SEEK_HEADER_START;
@@ -79,12 +78,64 @@ static int lattice_read_bit_file(struct lattice_bit_file *bit_file, const char *
 		return ERROR_PLD_FILE_LOAD_FAILED;
 	}
 
+	return ERROR_OK;
+}
+
+static int lattice_read_bit_file(struct lattice_bit_file *bit_file, const char *filename, enum lattice_family_e family)
+{
+	int retval = cpld_read_raw_bit_file(&bit_file->raw_bit, filename);
+	if (retval != ERROR_OK)
+		return retval;
+
+	retval = lattice_parse_bit_header(bit_file, family);
+	if (retval != ERROR_OK) {
+		free(bit_file->raw_bit.data);
+		return retval;
+	}
+	cpld_init_raw_bit_stream(&bit_file->stream, NULL, 0);
+
 	for (size_t i = bit_file->offset; i < bit_file->raw_bit.length; i++)
 		bit_file->raw_bit.data[i] = flip_u32(bit_file->raw_bit.data[i], 8);
 
 	return ERROR_OK;
 }
 
+/*
+ * Only read and parse the header of a .bit file, the bitstream following it
+ * is left in bit_file->stream to be shifted out with cpld_scan_raw_bit_stream().
+ */
+static int lattice_open_bit_stream(struct lattice_bit_file *bit_file, const char *filename,
+	enum lattice_family_e family)
+{
+	struct raw_bit_stream *stream = &bit_file->stream;
+
+	int retval = cpld_open_raw_bit_stream(stream, filename, RAW_BIT_BINARY, 0);
+	if (retval != ERROR_OK)
+		return retval;
+
+	bit_file->raw_bit.length = MIN(stream->length, LATTICE_BIT_HEADER_SIZE_MAX);
+	bit_file->raw_bit.data = malloc(bit_file->raw_bit.length);
+	if (!bit_file->raw_bit.data) {
+		cpld_close_raw_bit_stream(stream);
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+
+	retval = cpld_read_raw_bit_stream(stream, bit_file->raw_bit.data, bit_file->raw_bit.length);
+	cpld_close_raw_bit_stream(stream);
+	if (retval == ERROR_OK)
+		retval = lattice_parse_bit_header(bit_file, family);
+	if (retval == ERROR_OK)
+		retval = cpld_open_raw_bit_stream(stream, filename, RAW_BIT_BINARY, bit_file->offset);
+	if (retval != ERROR_OK) {
+		free(bit_file->raw_bit.data);
+		return retval;
+	}
+	stream->flip = true;
+
+	return ERROR_OK;
+}
+
 int lattice_read_file(struct lattice_bit_file *bit_file, const char *filename, enum lattice_family_e family)
 {
 	if (!filename || !bit_file)
@@ -97,9 +148,19 @@ int lattice_read_file(struct lattice_bit_file *bit_file, const char *filename, e
 		return ERROR_PLD_FILE_LOAD_FAILED;
 	}
 
-	if (strcasecmp(file_suffix_pos, ".bit") == 0)
+	if (strcasecmp(file_suffix_pos, ".bit") == 0) {
+		/* ECP5 and Certus shift the bitstream in one go, no need to buffer it */
+		if (family == LATTICE_ECP5 || family == LATTICE_CERTUS)
+			return lattice_open_bit_stream(bit_file, filename, family);
 		return lattice_read_bit_file(bit_file, filename, family);
+	}
 
 	LOG_ERROR("Filetype not supported");
 	return ERROR_PLD_FILE_LOAD_FAILED;
 }
+
+void lattice_free_file(struct lattice_bit_file *bit_file)
+{
+	cpld_close_raw_bit_stream(&bit_file->stream);
+	free(bit_file->raw_bit.data);
+}
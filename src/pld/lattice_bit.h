@@ -13,7 +13,8 @@
 
 
 struct lattice_bit_file {
-	struct raw_bit_file raw_bit;
+	struct raw_bit_file raw_bit;	/* only the header for ECP5 and Certus */
+	struct raw_bit_stream stream;	/* bitstream not read into raw_bit yet */
 	size_t offset;
 	uint32_t idcode;
 	const char *part; /* reuses memory in raw_bit_file */
@@ -29,5 +30,6 @@ enum lattice_family_e {
 };
 
 int lattice_read_file(struct lattice_bit_file *bit_file, const char *filename, enum lattice_family_e family);
+void lattice_free_file(struct lattice_bit_file *bit_file);
 
 #endif /* OPENOCD_PLD_LATTICE_BIT_H */
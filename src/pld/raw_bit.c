@@ -12,9 +12,13 @@
 #include "raw_bit.h"
 #include "pld.h"
 
+#include <helper/binarybuffer.h>
 #include <helper/system.h>
 #include <helper/log.h>
 
+/* Bytes of bitstream shifted per DR scan by cpld_scan_raw_bit_stream() */
+#define RAW_BIT_STREAM_CHUNK_SIZE	(64 * 1024)
+
 
 int cpld_read_raw_bit_file(struct raw_bit_file *bit_file, const char *filename)
 {
@@ -53,3 +57,200 @@ int cpld_read_raw_bit_file(struct raw_bit_file *bit_file, const char *filename)
 
 	return ERROR_OK;
 }
+
+/**
+ * Open @a filename for streaming, starting at byte @a offset of the file.
+ * For RAW_BIT_HEX files each byte of the bitstream takes 3 bytes of the file.
+ */
+int cpld_open_raw_bit_stream(struct raw_bit_stream *stream, const char *filename,
+	enum raw_bit_format format, size_t offset)
+{
+	FILE *input_file = fopen(filename, "rb");
+
+	if (!input_file) {
+		LOG_ERROR("Couldn't open %s: %s", filename, strerror(errno));
+		return ERROR_PLD_FILE_LOAD_FAILED;
+	}
+
+	fseek(input_file, 0, SEEK_END);
+	long length = ftell(input_file);
+
+	if (length < 0 || (size_t)length < offset || fseek(input_file, offset, SEEK_SET) != 0) {
+		fclose(input_file);
+		LOG_ERROR("Failed to get length of file %s: %s", filename, strerror(errno));
+		return ERROR_PLD_FILE_LOAD_FAILED;
+	}
+	length -= offset;
+
+	if (format == RAW_BIT_HEX) {
+		if (length % 3) {
+			fclose(input_file);
+			LOG_ERROR("unexpected line length");
+			return ERROR_PLD_FILE_LOAD_FAILED;
+		}
+		length /= 3;
+	}
+
+	stream->file = input_file;
+	stream->data = NULL;
+	stream->length = (size_t)length;
+	stream->format = format;
+	stream->flip = false;
+
+	return ERROR_OK;
+}
+
+/** Stream a bitstream already in memory, @a data must stay valid until the stream is closed. */
+void cpld_init_raw_bit_stream(struct raw_bit_stream *stream, const uint8_t *data, size_t length)
+{
+	stream->file = NULL;
+	stream->data = data;
+	stream->length = length;
+	stream->format = RAW_BIT_BINARY;
+	stream->flip = false;
+}
+
+static int cpld_read_raw_bit_hex(FILE *input_file, uint8_t *buffer, size_t size)
+{
+	char lines[3 * 256];
+
+	while (size) {
+		size_t count = MIN(size, sizeof(lines) / 3);
+		if (fread(lines, 3, count, input_file) != count) {
+			LOG_ERROR("Failed to read bitstream: %s", strerror(errno));
+			return ERROR_PLD_FILE_LOAD_FAILED;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			const char *line = lines + 3 * i;
+			if (line[2] != '\n') {
+				LOG_ERROR("unexpected line length");
+				return ERROR_PLD_FILE_LOAD_FAILED;
+			}
+			if (!isxdigit(line[0]) || !isxdigit(line[1])) {
+				LOG_ERROR("unexpected char in hex string");
+				return ERROR_PLD_FILE_LOAD_FAILED;
+			}
+			unhexify(buffer++, line, 2);
+		}
+		size -= count;
+	}
+
+	return ERROR_OK;
+}
+
+/** Read the next @a size bytes of the bitstream, @a size must not exceed stream->length. */
+int cpld_read_raw_bit_stream(struct raw_bit_stream *stream, uint8_t *buffer, size_t size)
+{
+	if (size > stream->length) {
+		LOG_ERROR("BUG: reading beyond the end of the bitstream");
+		return ERROR_FAIL;
+	}
+
+	if (!stream->file) {
+		memcpy(buffer, stream->data, size);
+		stream->data += size;
+	} else if (stream->format == RAW_BIT_HEX) {
+		int retval = cpld_read_raw_bit_hex(stream->file, buffer, size);
+		if (retval != ERROR_OK)
+			return retval;
+	} else if (fread(buffer, 1, size, stream->file) != size) {
+		LOG_ERROR("Failed to read bitstream: %s", strerror(errno));
+		return ERROR_PLD_FILE_LOAD_FAILED;
+	}
+	stream->length -= size;
+
+	if (stream->flip)
+		for (size_t i = 0; i < size; i++)
+			buffer[i] = flip_u32(buffer[i], 8);
+
+	return ERROR_OK;
+}
+
+void cpld_close_raw_bit_stream(struct raw_bit_stream *stream)
+{
+	if (stream->file)
+		fclose(stream->file);
+	stream->file = NULL;
+	stream->data = NULL;
+	stream->length = 0;
+}
+
+/**
+ * Shift the whole bitstream, followed by @a trailing_zeros zero bits, into the
+ * DR of @a tap, all other TAPs being in BYPASS.
+ *
+ * The bitstream is read and queued in chunks of RAW_BIT_STREAM_CHUNK_SIZE
+ * bytes, so neither the file nor the JTAG queue ever holds all of it. Between
+ * chunks the TAP waits in DRPAUSE and returns to DRSHIFT through DREXIT2, so
+ * the device sees one continuous scan without Capture-DR or Update-DR.
+ */
+int cpld_scan_raw_bit_stream(struct jtag_tap *tap, struct raw_bit_stream *stream,
+	unsigned int trailing_zeros, tap_state_t end_state)
+{
+	static const tap_state_t resume_shift[] = { TAP_DREXIT2, TAP_DRSHIFT };
+	unsigned int zeros_before = 0;
+	unsigned int zeros_after = trailing_zeros;
+	bool found = false;
+
+	/* the one bit BYPASS registers of the other TAPs are shifted once only */
+	for (struct jtag_tap *t = jtag_tap_next_enabled(NULL); t; t = jtag_tap_next_enabled(t)) {
+		if (t == tap)
+			found = true;
+		else if (found)
+			zeros_after++;
+		else
+			zeros_before++;
+	}
+	if (!found) {
+		LOG_ERROR("TAP %s is not enabled", jtag_tap_name(tap));
+		return ERROR_FAIL;
+	}
+
+	if (!stream->length) {
+		LOG_ERROR("empty bitstream");
+		return ERROR_PLD_FILE_LOAD_FAILED;
+	}
+
+	uint8_t *buffer = malloc(RAW_BIT_STREAM_CHUNK_SIZE);
+	if (!buffer) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+
+	int retval = ERROR_OK;
+	bool first = true;
+	while (zeros_before || stream->length || zeros_after) {
+		unsigned int num_bits;
+
+		if (zeros_before) {
+			num_bits = MIN(zeros_before, RAW_BIT_STREAM_CHUNK_SIZE * 8);
+			memset(buffer, 0, DIV_ROUND_UP(num_bits, 8));
+			zeros_before -= num_bits;
+		} else if (stream->length) {
+			size_t size = MIN(stream->length, RAW_BIT_STREAM_CHUNK_SIZE);
+			retval = cpld_read_raw_bit_stream(stream, buffer, size);
+			if (retval != ERROR_OK)
+				break;
+			num_bits = size * 8;
+		} else {
+			num_bits = MIN(zeros_after, RAW_BIT_STREAM_CHUNK_SIZE * 8);
+			memset(buffer, 0, DIV_ROUND_UP(num_bits, 8));
+			zeros_after -= num_bits;
+		}
+
+		bool last = !zeros_before && !stream->length && !zeros_after;
+		if (!first)
+			jtag_add_pathmove(ARRAY_SIZE(resume_shift), resume_shift);
+		jtag_add_plain_dr_scan(num_bits, buffer, NULL, last ? end_state : TAP_DRPAUSE);
+		first = false;
+
+		retval = jtag_execute_queue();
+		if (retval != ERROR_OK)
+			break;
+		keep_alive();
+	}
+
+	free(buffer);
+	return retval;
+}
@@ -8,14 +8,44 @@
 #ifndef OPENOCD_PLD_RAW_BIN_H
 #define OPENOCD_PLD_RAW_BIN_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
+
+#include <jtag/jtag.h>
 
 struct raw_bit_file {
 	size_t length;
 	uint8_t *data;
 };
 
+enum raw_bit_format {
+	RAW_BIT_BINARY,		/* plain bytes */
+	RAW_BIT_HEX,		/* one byte per line as two hex digits */
+};
+
+/**
+ * Bitstream which is read piecewise while it is shifted into the device,
+ * either from a file or from a buffer owned by the caller.
+ */
+struct raw_bit_stream {
+	FILE *file;
+	const uint8_t *data;	/* used if file is NULL */
+	size_t length;			/* bytes of bitstream not read yet */
+	enum raw_bit_format format;
+	bool flip;				/* reverse the bit order of every byte */
+};
+
 int cpld_read_raw_bit_file(struct raw_bit_file *bit_file, const char *filename);
 
+int cpld_open_raw_bit_stream(struct raw_bit_stream *stream, const char *filename,
+	enum raw_bit_format format, size_t offset);
+void cpld_init_raw_bit_stream(struct raw_bit_stream *stream, const uint8_t *data, size_t length);
+int cpld_read_raw_bit_stream(struct raw_bit_stream *stream, uint8_t *buffer, size_t size);
+void cpld_close_raw_bit_stream(struct raw_bit_stream *stream);
+
+int cpld_scan_raw_bit_stream(struct jtag_tap *tap, struct raw_bit_stream *stream,
+	unsigned int trailing_zeros, tap_state_t end_state);
+
 #endif /* OPENOCD_PLD_RAW_BIN_H */
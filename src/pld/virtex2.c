@@ -229,37 +229,22 @@ static int virtex2_load(struct pld_device *pld_device, const char *filename)
 {
 	struct virtex2_pld_device *virtex2_info = pld_device->driver_priv;
 	struct xilinx_bit_file bit_file;
+	struct raw_bit_stream stream;
 	int retval;
-	unsigned int i;
-	struct scan_field field;
 
-	field.in_value = NULL;
-
-	retval = xilinx_read_bit_file(&bit_file, filename);
+	retval = xilinx_read_bit_file(&bit_file, filename, &stream);
 	if (retval != ERROR_OK)
 		return retval;
 
 	retval = virtex2_load_prepare(pld_device);
-	if (retval != ERROR_OK) {
-		xilinx_free_bit_file(&bit_file);
-		return retval;
-	}
-
-	for (i = 0; i < bit_file.length; i++)
-		bit_file.data[i] = flip_u32(bit_file.data[i], 8);
-
-	field.num_bits = bit_file.length * 8;
-	field.out_value = bit_file.data;
-
-	jtag_add_dr_scan(virtex2_info->tap, 1, &field, TAP_DRPAUSE);
-	retval = jtag_execute_queue();
-	if (retval != ERROR_OK) {
-		xilinx_free_bit_file(&bit_file);
-		return retval;
+	if (retval == ERROR_OK) {
+		stream.flip = true;
+		retval = cpld_scan_raw_bit_stream(virtex2_info->tap, &stream, 0, TAP_DRPAUSE);
 	}
+	if (retval == ERROR_OK)
+		retval = virtex2_load_cleanup(pld_device);
 
-	retval = virtex2_load_cleanup(pld_device);
-
+	cpld_close_raw_bit_stream(&stream);
 	xilinx_free_bit_file(&bit_file);
 
 	return retval;
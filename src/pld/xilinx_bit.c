@@ -47,7 +47,13 @@ static int read_section(FILE *input_file, int length_size, char section,
 	if (buffer_length)
 		*buffer_length = length;
 
+	/* section is streamed later, leave the file at its start */
+	if (!buffer)
+		return ERROR_OK;
+
 	*buffer = malloc(length);
+	if (!*buffer)
+		return ERROR_PLD_FILE_LOAD_FAILED;
 
 	read_count = fread(*buffer, 1, length, input_file);
 	if (read_count != length)
@@ -56,7 +62,12 @@ static int read_section(FILE *input_file, int length_size, char section,
 	return ERROR_OK;
 }
 
-int xilinx_read_bit_file(struct xilinx_bit_file *bit_file, const char *filename)
+/**
+ * Parse the header of a .bit file and open @a stream on its configuration
+ * data, which is not read into memory.
+ */
+int xilinx_read_bit_file(struct xilinx_bit_file *bit_file, const char *filename,
+	struct raw_bit_stream *stream)
 {
 	FILE *input_file;
 	int read_count;
@@ -74,7 +85,6 @@ int xilinx_read_bit_file(struct xilinx_bit_file *bit_file, const char *filename)
 	bit_file->part_name = NULL;
 	bit_file->date = NULL;
 	bit_file->time = NULL;
-	bit_file->data = NULL;
 
 	read_count = fread(bit_file->unknown_header, 1, 13, input_file);
 	if (read_count != 13) {
@@ -107,7 +117,7 @@ int xilinx_read_bit_file(struct xilinx_bit_file *bit_file, const char *filename)
 		return ERROR_PLD_FILE_LOAD_FAILED;
 	}
 
-	if (read_section(input_file, 4, 'e', &bit_file->length, &bit_file->data) != ERROR_OK) {
+	if (read_section(input_file, 4, 'e', &bit_file->length, NULL) != ERROR_OK) {
 		xilinx_free_bit_file(bit_file);
 		fclose(input_file);
 		return ERROR_PLD_FILE_LOAD_FAILED;
@@ -116,8 +126,28 @@ int xilinx_read_bit_file(struct xilinx_bit_file *bit_file, const char *filename)
 	LOG_DEBUG("bit_file: %s %s %s,%s %" PRIu32 "", bit_file->source_file, bit_file->part_name,
 		bit_file->date, bit_file->time, bit_file->length);
 
+	long offset = ftell(input_file);
 	fclose(input_file);
 
+	if (offset < 0) {
+		xilinx_free_bit_file(bit_file);
+		return ERROR_PLD_FILE_LOAD_FAILED;
+	}
+
+	int retval = cpld_open_raw_bit_stream(stream, filename, RAW_BIT_BINARY, offset);
+	if (retval != ERROR_OK) {
+		xilinx_free_bit_file(bit_file);
+		return retval;
+	}
+
+	if (stream->length < bit_file->length) {
+		LOG_ERROR("file '%s' is truncated", filename);
+		cpld_close_raw_bit_stream(stream);
+		xilinx_free_bit_file(bit_file);
+		return ERROR_PLD_FILE_LOAD_FAILED;
+	}
+	stream->length = bit_file->length;
+
 	return ERROR_OK;
 }
 
@@ -127,5 +157,4 @@ void xilinx_free_bit_file(struct xilinx_bit_file *bit_file)
 	free(bit_file->part_name);
 	free(bit_file->date);
 	free(bit_file->time);
-	free(bit_file->data);
 }
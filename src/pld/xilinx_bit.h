@@ -9,6 +9,7 @@
 #define OPENOCD_PLD_XILINX_BIT_H
 
 #include "helper/types.h"
+#include "raw_bit.h"
 
 struct xilinx_bit_file {
 	uint8_t unknown_header[13];
@@ -17,10 +18,10 @@ struct xilinx_bit_file {
 	uint8_t *date;
 	uint8_t *time;
 	uint32_t length;
-	uint8_t *data;
 };
 
-int xilinx_read_bit_file(struct xilinx_bit_file *bit_file, const char *filename);
+int xilinx_read_bit_file(struct xilinx_bit_file *bit_file, const char *filename,
+	struct raw_bit_stream *stream);
 
 void xilinx_free_bit_file(struct xilinx_bit_file *bit_file);
 
@@ -76,6 +76,9 @@ static const struct freertos_params freertos_params_list[] = {
 static bool freertos_detect_rtos(struct target *target);
 static int freertos_create(struct target *target);
 static int freertos_update_threads(struct rtos *rtos);
+static int freertos_get_thread_list_generation(struct rtos *rtos,
+		uint64_t *generation);
+static int freertos_update_current_thread(struct rtos *rtos);
 static int freertos_get_thread_reg_list(struct rtos *rtos, int64_t thread_id,
 		struct rtos_reg **reg_list, int *num_regs);
 static int freertos_get_symbol_list_to_lookup(struct symbol_table_elem *symbol_list[]);
@@ -86,6 +89,8 @@ const struct rtos_type freertos_rtos = {
 	.detect_rtos = freertos_detect_rtos,
 	.create = freertos_create,
 	.update_threads = freertos_update_threads,
+	.get_thread_list_generation = freertos_get_thread_list_generation,
+	.update_current_thread = freertos_update_current_thread,
 	.get_thread_reg_list = freertos_get_thread_reg_list,
 	.get_symbol_list_to_lookup = freertos_get_symbol_list_to_lookup,
 };
@@ -103,6 +108,7 @@ enum freertos_symbol_values {
 	FREERTOS_VAL_UX_CURRENT_NUMBER_OF_TASKS = 9,
 	FREERTOS_VAL_UX_TOP_USED_PRIORITY = 10,
 	FREERTOS_VAL_X_SCHEDULER_RUNNING = 11,
+	FREERTOS_VAL_UX_TASK_NUMBER = 12,
 };
 
 struct symbols {
@@ -123,6 +129,7 @@ static const struct symbols freertos_symbol_list[] = {
 	{ "uxCurrentNumberOfTasks", false },
 	{ "uxTopUsedPriority", true }, /* Unavailable since v7.5.3 */
 	{ "xSchedulerRunning", false },
+	{ "uxTaskNumber", true }, /* Only used to detect thread list changes */
 	{ NULL, false }
 };
 
@@ -153,7 +160,7 @@ static int freertos_update_threads(struct rtos *rtos)
 	}
 
 	uint32_t thread_list_size = 0;
-	retval = target_read_u32(rtos->target,
+	retval = rtos_snapshot_read_u32(rtos,
 			rtos->symbols[FREERTOS_VAL_UX_CURRENT_NUMBER_OF_TASKS].address,
 			&thread_list_size);
 	LOG_DEBUG("FreeRTOS: Read uxCurrentNumberOfTasks at 0x%" PRIx64 ", value %" PRIu32,
@@ -170,7 +177,7 @@ static int freertos_update_threads(struct rtos *rtos)
 
 	/* read the current thread */
 	uint32_t pointer_casts_are_bad;
-	retval = target_read_u32(rtos->target,
+	retval = rtos_snapshot_read_u32(rtos,
 			rtos->symbols[FREERTOS_VAL_PX_CURRENT_TCB].address,
 			&pointer_casts_are_bad);
 	if (retval != ERROR_OK) {
@@ -184,7 +191,7 @@ static int freertos_update_threads(struct rtos *rtos)
 
 	/* read scheduler running */
 	uint32_t scheduler_running;
-	retval = target_read_u32(rtos->target,
+	retval = rtos_snapshot_read_u32(rtos,
 			rtos->symbols[FREERTOS_VAL_X_SCHEDULER_RUNNING].address,
 			&scheduler_running);
 	if (retval != ERROR_OK) {
@@ -235,7 +242,7 @@ static int freertos_update_threads(struct rtos *rtos)
 		return ERROR_FAIL;
 	}
 	uint32_t top_used_priority = 0;
-	retval = target_read_u32(rtos->target,
+	retval = rtos_snapshot_read_u32(rtos,
 			rtos->symbols[FREERTOS_VAL_UX_TOP_USED_PRIORITY].address,
 			&top_used_priority);
 	if (retval != ERROR_OK)
@@ -280,7 +287,7 @@ static int freertos_update_threads(struct rtos *rtos)
 
 		/* Read the number of threads in this list */
 		uint32_t list_thread_count = 0;
-		retval = target_read_u32(rtos->target,
+		retval = rtos_snapshot_read_u32(rtos,
 				list_of_lists[i],
 				&list_thread_count);
 		if (retval != ERROR_OK) {
@@ -297,7 +304,7 @@ static int freertos_update_threads(struct rtos *rtos)
 		/* Read the location of first list item */
 		uint32_t prev_list_elem_ptr = -1;
 		uint32_t list_elem_ptr = 0;
-		retval = target_read_u32(rtos->target,
+		retval = rtos_snapshot_read_u32(rtos,
 				list_of_lists[i] + param->list_next_offset,
 				&list_elem_ptr);
 		if (retval != ERROR_OK) {
@@ -312,7 +319,7 @@ static int freertos_update_threads(struct rtos *rtos)
 				(list_elem_ptr != prev_list_elem_ptr) &&
 				(tasks_found < thread_list_size)) {
 			/* Get the location of the thread structure. */
-			retval = target_read_u32(rtos->target,
+			retval = rtos_snapshot_read_u32(rtos,
 					list_elem_ptr + param->list_elem_content_offset,
 					&pointer_casts_are_bad);
 			if (retval != ERROR_OK) {
@@ -331,7 +338,7 @@ static int freertos_update_threads(struct rtos *rtos)
 			char tmp_str[FREERTOS_THREAD_NAME_STR_SIZE];
 
 			/* Read the thread name */
-			retval = target_read_buffer(rtos->target,
+			retval = rtos_snapshot_read_buffer(rtos,
 					rtos->thread_details[tasks_found].threadid + param->thread_name_offset,
 					FREERTOS_THREAD_NAME_STR_SIZE,
 					(uint8_t *)&tmp_str);
@@ -368,7 +375,7 @@ static int freertos_update_threads(struct rtos *rtos)
 
 			prev_list_elem_ptr = list_elem_ptr;
 			list_elem_ptr = 0;
-			retval = target_read_u32(rtos->target,
+			retval = rtos_snapshot_read_u32(rtos,
 					prev_list_elem_ptr + param->list_elem_next_offset,
 					&list_elem_ptr);
 			if (retval != ERROR_OK) {
@@ -386,6 +393,88 @@ static int freertos_update_threads(struct rtos *rtos)
 	return 0;
 }
 
+static int freertos_get_thread_list_generation(struct rtos *rtos,
+		uint64_t *generation)
+{
+	uint32_t task_number, thread_list_size, scheduler_running;
+	int retval;
+
+	if (!rtos->symbols ||
+			rtos->symbols[FREERTOS_VAL_UX_TASK_NUMBER].address == 0 ||
+			rtos->symbols[FREERTOS_VAL_UX_CURRENT_NUMBER_OF_TASKS].address == 0 ||
+			rtos->symbols[FREERTOS_VAL_X_SCHEDULER_RUNNING].address == 0)
+		return ERROR_NOT_IMPLEMENTED;
+
+	/* uxTaskNumber is incremented on every task creation and
+	 * uxCurrentNumberOfTasks is decremented on every task deletion. */
+	retval = rtos_snapshot_read_u32(rtos,
+			rtos->symbols[FREERTOS_VAL_UX_TASK_NUMBER].address,
+			&task_number);
+	if (retval != ERROR_OK)
+		return retval;
+
+	retval = rtos_snapshot_read_u32(rtos,
+			rtos->symbols[FREERTOS_VAL_UX_CURRENT_NUMBER_OF_TASKS].address,
+			&thread_list_size);
+	if (retval != ERROR_OK)
+		return retval;
+
+	retval = rtos_snapshot_read_u32(rtos,
+			rtos->symbols[FREERTOS_VAL_X_SCHEDULER_RUNNING].address,
+			&scheduler_running);
+	if (retval != ERROR_OK)
+		return retval;
+
+	*generation = ((uint64_t)task_number << 32) |
+		((thread_list_size & 0x7fffffff) << 1) | (scheduler_running & 1);
+
+	return ERROR_OK;
+}
+
+static int freertos_update_current_thread(struct rtos *rtos)
+{
+	uint32_t current_tcb;
+	int retval;
+	int current = -1;
+
+	/* The full update makes the "Current Execution" pseudo thread 1 current
+	 * while the scheduler is not running, even if pxCurrentTCB is set. Only
+	 * the full update can keep that consistent. */
+	if (rtos->current_thread == 1)
+		return ERROR_FAIL;
+
+	retval = rtos_snapshot_read_u32(rtos,
+			rtos->symbols[FREERTOS_VAL_PX_CURRENT_TCB].address,
+			&current_tcb);
+	if (retval != ERROR_OK)
+		return retval;
+
+	/* The list without a current task holds a single pseudo thread, it is
+	 * rebuilt by the full update. */
+	if (current_tcb == 0)
+		return ERROR_FAIL;
+
+	for (int i = 0; i < rtos->thread_count; i++) {
+		if (rtos->thread_details[i].threadid == current_tcb)
+			current = i;
+	}
+
+	if (current < 0)
+		return ERROR_FAIL;
+
+	if (rtos->current_thread != current_tcb) {
+		for (int i = 0; i < rtos->thread_count; i++) {
+			free(rtos->thread_details[i].extra_info_str);
+			rtos->thread_details[i].extra_info_str = NULL;
+		}
+
+		rtos->thread_details[current].extra_info_str = strdup("State: Running");
+		rtos->current_thread = current_tcb;
+	}
+
+	return ERROR_OK;
+}
+
 static int freertos_get_thread_reg_list(struct rtos *rtos, int64_t thread_id,
 		struct rtos_reg **reg_list, int *num_regs)
 {
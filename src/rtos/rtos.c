@@ -43,6 +43,31 @@ int rtos_smp_init(struct target *target)
 	return ERROR_TARGET_INIT_FAILED;
 }
 
+/* Size of the memory blocks kept by the RTOS memory snapshot. */
+#define RTOS_SNAPSHOT_BLOCK_SIZE	256
+
+/* Number of memory blocks kept by the RTOS memory snapshot. */
+#define RTOS_SNAPSHOT_MAX_BLOCKS	64
+
+struct rtos_snapshot_block {
+	target_addr_t address;
+	bool valid;
+	uint8_t data[RTOS_SNAPSHOT_BLOCK_SIZE];
+};
+
+/*
+ * Host-side copy of the target memory holding the kernel structures. The
+ * RTOS drivers walk task lists with lots of small reads that mostly hit the
+ * same few memory areas (list heads, TCBs), so instead each read fetches
+ * the surrounding block once and serves the neighbouring reads from it.
+ */
+struct rtos_snapshot {
+	struct rtos_snapshot_block blocks[RTOS_SNAPSHOT_MAX_BLOCKS];
+	unsigned int next_victim;
+	unsigned int hits;
+	unsigned int misses;
+};
+
 static int rtos_target_for_threadid(struct connection *connection, int64_t threadid, struct target **t)
 {
 	struct target *curr = get_target_from_connection(connection);
@@ -78,6 +103,7 @@ static void os_free(struct target *target)
 		return;
 
 	free(target->rtos->symbols);
+	free(target->rtos->snapshot);
 	free(target->rtos);
 	target->rtos = NULL;
 }
@@ -170,8 +196,11 @@ static struct symbol_table_elem *next_symbol(struct rtos *os, char *cur_symbol,
 	if (!os->symbols)
 		os->type->get_symbol_list_to_lookup(&os->symbols);
 
-	if (!cur_symbol[0])
+	if (!cur_symbol[0]) {
+		/* Symbols may move, do not trust the cached thread list anymore. */
+		os->thread_list_generation_valid = false;
 		return &os->symbols[0];
+	}
 
 	struct symbol_table_elem *s = find_symbol(os, cur_symbol);
 	if (!s)
@@ -392,7 +421,9 @@ int rtos_thread_packet(struct connection *connection, char const *packet, int pa
 				target->rtos_auto_detect = false;
 				target->rtos->type->create(target);
 			}
-			target->rtos->type->update_threads(target->rtos);
+			/* the symbols just looked up may belong to a new image */
+			target->rtos->thread_list_generation_valid = false;
+			rtos_update_threads(target);
 		}
 		return ERROR_OK;
 	} else if (strncmp(packet, "qfThreadInfo", 12) == 0) {
@@ -684,10 +715,66 @@ static int rtos_try_next(struct target *target)
 	return 1;
 }
 
+/* Refresh only the current thread if the thread list did not change since
+ * the last full update, e.g. after a single step. Otherwise @a generation
+ * is set to that of the list the full update is going to read, if known. */
+static int rtos_update_current_thread(struct rtos *rtos, uint64_t *generation,
+		bool *generation_valid)
+{
+	*generation_valid = false;
+
+	if (!rtos->type->get_thread_list_generation || !rtos->type->update_current_thread)
+		return ERROR_NOT_IMPLEMENTED;
+
+	if (rtos->type->get_thread_list_generation(rtos, generation) != ERROR_OK)
+		return ERROR_FAIL;
+
+	if (rtos->thread_details && rtos->thread_list_generation_valid &&
+			rtos->thread_list_generation == *generation) {
+		/* The thread selected by gdb is reset just like on a full update. */
+		rtos->current_threadid = -1;
+
+		if (rtos->type->update_current_thread(rtos) == ERROR_OK) {
+			LOG_DEBUG("RTOS: thread list unchanged, current thread 0x%" PRIx64,
+				rtos->current_thread);
+			return ERROR_OK;
+		}
+	}
+
+	*generation_valid = true;
+
+	return ERROR_FAIL;
+}
+
 int rtos_update_threads(struct target *target)
 {
-	if ((target->rtos) && (target->rtos->type))
-		target->rtos->type->update_threads(target->rtos);
+	struct rtos *rtos = target->rtos;
+	uint64_t generation;
+	bool generation_valid;
+
+	if (!rtos || !rtos->type)
+		return ERROR_OK;
+
+	/* The kernel structures may have changed since the last update. */
+	if (!rtos->snapshot)
+		rtos->snapshot = calloc(1, sizeof(struct rtos_snapshot));
+	rtos_snapshot_invalidate(rtos);
+
+	if (rtos_update_current_thread(rtos, &generation, &generation_valid) != ERROR_OK) {
+		/* Only a complete thread list may be refreshed incrementally later. */
+		rtos->thread_list_generation_valid = false;
+		if (rtos->type->update_threads(rtos) == ERROR_OK && generation_valid) {
+			rtos->thread_list_generation = generation;
+			rtos->thread_list_generation_valid = true;
+		}
+	}
+
+	if (rtos->snapshot)
+		LOG_DEBUG("RTOS: %u reads served from snapshot, %u target reads",
+			rtos->snapshot->hits, rtos->snapshot->misses);
+
+	rtos_snapshot_invalidate(rtos);
+
 	return ERROR_OK;
 }
 
@@ -724,3 +811,96 @@ int rtos_write_buffer(struct target *target, target_addr_t address,
 		return target->rtos->type->write_buffer(target->rtos, address, size, buffer);
 	return ERROR_NOT_IMPLEMENTED;
 }
+
+void rtos_snapshot_invalidate(struct rtos *rtos)
+{
+	struct rtos_snapshot *snapshot = rtos->snapshot;
+
+	if (!snapshot)
+		return;
+
+	for (unsigned int i = 0; i < RTOS_SNAPSHOT_MAX_BLOCKS; i++)
+		snapshot->blocks[i].valid = false;
+
+	snapshot->next_victim = 0;
+	snapshot->hits = 0;
+	snapshot->misses = 0;
+}
+
+static struct rtos_snapshot_block *rtos_snapshot_get_block(struct rtos *rtos,
+		target_addr_t address)
+{
+	struct rtos_snapshot *snapshot = rtos->snapshot;
+	struct rtos_snapshot_block *block;
+
+	for (unsigned int i = 0; i < RTOS_SNAPSHOT_MAX_BLOCKS; i++) {
+		block = &snapshot->blocks[i];
+		if (block->valid && block->address == address) {
+			snapshot->hits++;
+			return block;
+		}
+	}
+
+	/* Not cached yet, replace the blocks round-robin. */
+	block = &snapshot->blocks[snapshot->next_victim];
+	snapshot->next_victim = (snapshot->next_victim + 1) % RTOS_SNAPSHOT_MAX_BLOCKS;
+	snapshot->misses++;
+
+	block->valid = false;
+	if (target_read_buffer(rtos->target, address, RTOS_SNAPSHOT_BLOCK_SIZE,
+			block->data) != ERROR_OK)
+		return NULL;
+
+	block->address = address;
+	block->valid = true;
+
+	return block;
+}
+
+int rtos_snapshot_read_buffer(struct rtos *rtos, target_addr_t address,
+		uint32_t size, uint8_t *buffer)
+{
+	if (!rtos->snapshot)
+		return target_read_buffer(rtos->target, address, size, buffer);
+
+	while (size > 0) {
+		target_addr_t block_address = address & ~(target_addr_t)(RTOS_SNAPSHOT_BLOCK_SIZE - 1);
+		uint32_t offset = address - block_address;
+		uint32_t length = MIN(size, RTOS_SNAPSHOT_BLOCK_SIZE - offset);
+
+		struct rtos_snapshot_block *block = rtos_snapshot_get_block(rtos, block_address);
+
+		/* The whole block may not be readable, e.g. at the end of RAM,
+		 * fall back to reading exactly what was requested. */
+		if (!block)
+			return target_read_buffer(rtos->target, address, size, buffer);
+
+		memcpy(buffer, block->data + offset, length);
+
+		address += length;
+		buffer += length;
+		size -= length;
+	}
+
+	return ERROR_OK;
+}
+
+int rtos_snapshot_read_u32(struct rtos *rtos, target_addr_t address,
+		uint32_t *value)
+{
+	uint8_t buf[4];
+
+	int retval = rtos_snapshot_read_buffer(rtos, address, sizeof(buf), buf);
+	if (retval != ERROR_OK)
+		return retval;
+
+	*value = target_buffer_get_u32(rtos->target, buf);
+
+	return ERROR_OK;
+}
+
+int rtos_snapshot_read_u8(struct rtos *rtos, target_addr_t address,
+		uint8_t *value)
+{
+	return rtos_snapshot_read_buffer(rtos, address, 1, value);
+}
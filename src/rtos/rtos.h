@@ -16,6 +16,7 @@ typedef int64_t threadid_t;
 typedef int64_t symbol_address_t;
 
 struct reg;
+struct rtos_snapshot;
 
 /**
  * Table should be terminated by an element with NULL in symbol_name
@@ -48,6 +49,11 @@ struct rtos {
 	int (*gdb_thread_packet)(struct connection *connection, char const *packet, int packet_size);
 	int (*gdb_target_for_threadid)(struct connection *connection, int64_t thread_id, struct target **p_target);
 	void *rtos_specific_params;
+	/* Host-side copy of target memory, only valid during update_threads(). */
+	struct rtos_snapshot *snapshot;
+	/* Thread list generation the thread details were read for. */
+	uint64_t thread_list_generation;
+	bool thread_list_generation_valid;
 };
 
 struct rtos_reg {
@@ -62,6 +68,12 @@ struct rtos_type {
 	int (*create)(struct target *target);
 	int (*smp_init)(struct target *target);
 	int (*update_threads)(struct rtos *rtos);
+	/** Optional: return a value that changes whenever the thread list, i.e.
+	 * the set of threads and their names, may have changed. Needs to be cheap. */
+	int (*get_thread_list_generation)(struct rtos *rtos, uint64_t *generation);
+	/** Optional: refresh only the current thread while the thread list
+	 * generation is unchanged. Return an error to request a full update. */
+	int (*update_current_thread)(struct rtos *rtos);
 	/** Return a list of general registers, with their values filled out. */
 	int (*get_thread_reg_list)(struct rtos *rtos, int64_t thread_id,
 			struct rtos_reg **reg_list, int *num_regs);
@@ -133,6 +145,15 @@ int rtos_smp_init(struct target *target);
 int rtos_qsymbol(struct connection *connection, char const *packet, int packet_size);
 int rtos_read_buffer(struct target *target, target_addr_t address,
 		uint32_t size, uint8_t *buffer);
+/*  functions for reading kernel structures through the memory snapshot,
+ *  only to be used from the update_threads() callback */
+int rtos_snapshot_read_buffer(struct rtos *rtos, target_addr_t address,
+		uint32_t size, uint8_t *buffer);
+int rtos_snapshot_read_u32(struct rtos *rtos, target_addr_t address,
+		uint32_t *value);
+int rtos_snapshot_read_u8(struct rtos *rtos, target_addr_t address,
+		uint8_t *value);
+void rtos_snapshot_invalidate(struct rtos *rtos);
 int rtos_write_buffer(struct target *target, target_addr_t address,
 		uint32_t size, const uint8_t *buffer);
 
@@ -503,7 +503,7 @@ static uint32_t zephyr_kptr(const struct rtos *rtos, enum zephyr_offsets off)
 	return rtos->symbols[ZEPHYR_VAL__KERNEL].address + params->offsets[off];
 }
 
-static int zephyr_fetch_thread(const struct rtos *rtos,
+static int zephyr_fetch_thread(struct rtos *rtos,
 				struct zephyr_thread *thread, uint32_t ptr)
 {
 	const struct zephyr_params *param = rtos->rtos_specific_params;
@@ -511,36 +511,36 @@ static int zephyr_fetch_thread(const struct rtos *rtos,
 
 	thread->ptr = ptr;
 
-	retval = target_read_u32(rtos->target, ptr + param->offsets[OFFSET_T_ENTRY],
+	retval = rtos_snapshot_read_u32(rtos, ptr + param->offsets[OFFSET_T_ENTRY],
 				 &thread->entry);
 	if (retval != ERROR_OK)
 		return retval;
 
-	retval = target_read_u32(rtos->target,
+	retval = rtos_snapshot_read_u32(rtos,
 				 ptr + param->offsets[OFFSET_T_NEXT_THREAD],
 				 &thread->next_ptr);
 	if (retval != ERROR_OK)
 		return retval;
 
-	retval = target_read_u32(rtos->target,
+	retval = rtos_snapshot_read_u32(rtos,
 				 ptr + param->offsets[OFFSET_T_STACK_POINTER],
 				 &thread->stack_pointer);
 	if (retval != ERROR_OK)
 		return retval;
 
-	retval = target_read_u8(rtos->target, ptr + param->offsets[OFFSET_T_STATE],
+	retval = rtos_snapshot_read_u8(rtos, ptr + param->offsets[OFFSET_T_STATE],
 				&thread->state);
 	if (retval != ERROR_OK)
 		return retval;
 
-	retval = target_read_u8(rtos->target,
+	retval = rtos_snapshot_read_u8(rtos,
 				ptr + param->offsets[OFFSET_T_USER_OPTIONS],
 				&thread->user_options);
 	if (retval != ERROR_OK)
 		return retval;
 
 	uint8_t prio;
-	retval = target_read_u8(rtos->target,
+	retval = rtos_snapshot_read_u8(rtos,
 				ptr + param->offsets[OFFSET_T_PRIO], &prio);
 	if (retval != ERROR_OK)
 		return retval;
@@ -548,7 +548,7 @@ static int zephyr_fetch_thread(const struct rtos *rtos,
 
 	thread->name[0] = '\0';
 	if (param->offsets[OFFSET_T_NAME] != UNIMPLEMENTED) {
-		retval = target_read_buffer(rtos->target,
+		retval = rtos_snapshot_read_buffer(rtos,
 					ptr + param->offsets[OFFSET_T_NAME],
 					sizeof(thread->name) - 1, (uint8_t *)thread->name);
 		if (retval != ERROR_OK)
@@ -573,7 +573,7 @@ static int zephyr_fetch_thread_list(struct rtos *rtos, uint32_t current_thread)
 	uint32_t curr;
 	int retval;
 
-	retval = target_read_u32(rtos->target, zephyr_kptr(rtos, OFFSET_K_THREADS),
+	retval = rtos_snapshot_read_u32(rtos, zephyr_kptr(rtos, OFFSET_K_THREADS),
 		&curr);
 	if (retval != ERROR_OK) {
 		LOG_ERROR("Could not fetch current thread pointer");
@@ -657,7 +657,7 @@ static int zephyr_update_threads(struct rtos *rtos)
 		return ERROR_FAIL;
 	}
 
-	retval = target_read_u8(rtos->target,
+	retval = rtos_snapshot_read_u8(rtos,
 		rtos->symbols[ZEPHYR_VAL__KERNEL_OPENOCD_SIZE_T_SIZE].address,
 		&param->size_width);
 	if (retval != ERROR_OK) {
@@ -671,7 +671,7 @@ static int zephyr_update_threads(struct rtos *rtos)
 	}
 
 	if (rtos->symbols[ZEPHYR_VAL__KERNEL_OPENOCD_NUM_OFFSETS].address) {
-		retval = target_read_u32(rtos->target,
+		retval = rtos_snapshot_read_u32(rtos,
 				rtos->symbols[ZEPHYR_VAL__KERNEL_OPENOCD_NUM_OFFSETS].address,
 				&param->num_offsets);
 		if (retval != ERROR_OK) {
@@ -684,7 +684,7 @@ static int zephyr_update_threads(struct rtos *rtos)
 			return ERROR_FAIL;
 		}
 	} else {
-		retval = target_read_u32(rtos->target,
+		retval = rtos_snapshot_read_u32(rtos,
 				rtos->symbols[ZEPHYR_VAL__KERNEL_OPENOCD_OFFSETS].address,
 				&param->offsets[OFFSET_VERSION]);
 		if (retval != ERROR_OK) {
@@ -716,7 +716,7 @@ static int zephyr_update_threads(struct rtos *rtos)
 			continue;
 		}
 
-		retval = target_read_u32(rtos->target, address, &param->offsets[i]);
+		retval = rtos_snapshot_read_u32(rtos, address, &param->offsets[i]);
 		if (retval != ERROR_OK) {
 			LOG_ERROR("Could not fetch offsets from Zephyr");
 			return ERROR_FAIL;
@@ -727,7 +727,7 @@ static int zephyr_update_threads(struct rtos *rtos)
 			  param->offsets[OFFSET_VERSION]);
 
 	uint32_t current_thread;
-	retval = target_read_u32(rtos->target,
+	retval = rtos_snapshot_read_u32(rtos,
 		zephyr_kptr(rtos, OFFSET_K_CURR_THREAD), &current_thread);
 	if (retval != ERROR_OK) {
 		LOG_ERROR("Could not obtain current thread ID");
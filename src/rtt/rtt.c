@@ -14,6 +14,7 @@
 
 #include <helper/log.h>
 #include <helper/list.h>
+#include <helper/time_support.h>
 #include <target/target.h>
 #include <target/rtt.h>
 
@@ -40,9 +41,25 @@ static struct {
 	bool found_cb;
 
 	struct rtt_sink_list **sink_list;
+	/** Up-channel statistics, same length as the sink list. */
+	struct rtt_channel_stats *stats;
+	/** Up-channel poll results, same length as the sink list. */
+	struct rtt_channel_read_result *results;
 	size_t sink_list_length;
 
 	unsigned int polling_interval;
+	/** Polling interval set by the user, used while not adaptive. */
+	unsigned int polling_interval_fixed;
+	/** Whether the polling interval adapts to the channel fill level. */
+	bool adaptive;
+	/** Minimal adaptive polling interval in milliseconds. */
+	unsigned int polling_interval_min;
+	/** Maximal adaptive polling interval in milliseconds. */
+	unsigned int polling_interval_max;
+	/** Highest up-channel fill level of the current poll in percent. */
+	unsigned int poll_fill_level;
+	/** Time RTT was started, in milliseconds. */
+	int64_t start_time;
 } rtt;
 
 int rtt_init(void)
@@ -54,10 +71,25 @@ int rtt_init(void)
 	if (!rtt.sink_list)
 		return ERROR_FAIL;
 
+	rtt.stats = calloc(rtt.sink_list_length, sizeof(struct rtt_channel_stats));
+	rtt.results = calloc(rtt.sink_list_length,
+		sizeof(struct rtt_channel_read_result));
+
+	if (!rtt.stats || !rtt.results) {
+		free(rtt.sink_list);
+		free(rtt.stats);
+		free(rtt.results);
+		return ERROR_FAIL;
+	}
+
 	rtt.sink_list[0] = NULL;
 	rtt.started = false;
 
 	rtt.polling_interval = 100;
+	rtt.polling_interval_fixed = 100;
+	rtt.adaptive = false;
+	rtt.polling_interval_min = 1;
+	rtt.polling_interval_max = 100;
 
 	return ERROR_OK;
 }
@@ -65,23 +97,101 @@ int rtt_init(void)
 int rtt_exit(void)
 {
 	free(rtt.sink_list);
+	free(rtt.stats);
+	free(rtt.results);
 
 	return ERROR_OK;
 }
 
+static int read_channel_callback(void *user_data);
+
+static void change_polling_interval(unsigned int interval)
+{
+	if (rtt.polling_interval == interval)
+		return;
+
+	/*
+	 * Re-registering would append a new timer that the running pass of the
+	 * timer callbacks reaches again, possibly from read_channel_callback()
+	 * itself.
+	 */
+	if (rtt.started)
+		target_set_timer_callback_interval(&read_channel_callback, NULL,
+			interval);
+
+	rtt.polling_interval = interval;
+}
+
+/* Account the results of a poll in the up-channel statistics */
+static void update_channel_stats(void)
+{
+	rtt.poll_fill_level = 0;
+
+	for (size_t i = 0; i < rtt.sink_list_length; i++) {
+		const struct rtt_channel_read_result *result = &rtt.results[i];
+		struct rtt_channel_stats *stats = &rtt.stats[i];
+		unsigned int fill_level;
+
+		if (!result->polled || !result->size)
+			continue;
+
+		fill_level = (uint64_t)result->pending * 100 / result->size;
+
+		stats->bytes += result->length;
+		stats->fill_level = fill_level;
+		stats->max_fill_level = MAX(stats->max_fill_level, fill_level);
+
+		if (fill_level >= RTT_FILL_LEVEL_CRITICAL)
+			stats->overflow_risk++;
+
+		rtt.poll_fill_level = MAX(rtt.poll_fill_level, fill_level);
+	}
+}
+
+static void adapt_polling_interval(void)
+{
+	unsigned int interval = rtt.polling_interval;
+
+	/*
+	 * Poll twice as fast as soon as a channel is filling up but back off
+	 * slowly while all channels stay empty, so that bursts are not lost.
+	 */
+	if (rtt.poll_fill_level >= RTT_FILL_LEVEL_HIGH)
+		interval /= 2;
+	else if (!rtt.poll_fill_level)
+		interval += interval / 4 + 1;
+
+	interval = MAX(interval, rtt.polling_interval_min);
+	interval = MIN(interval, rtt.polling_interval_max);
+
+	if (interval != rtt.polling_interval)
+		LOG_DEBUG("rtt: Polling interval changed to %u ms (fill level %u%%)",
+			interval, rtt.poll_fill_level);
+
+	change_polling_interval(interval);
+}
+
 static int read_channel_callback(void *user_data)
 {
 	int ret;
 
-	ret = rtt.source.read(rtt.target, &rtt.ctrl, rtt.sink_list,
+	memset(rtt.results, 0,
+		rtt.sink_list_length * sizeof(struct rtt_channel_read_result));
+
+	ret = rtt.source.read(rtt.target, &rtt.ctrl, rtt.sink_list, rtt.results,
 		rtt.sink_list_length, NULL);
 
+	update_channel_stats();
+
 	if (ret != ERROR_OK) {
 		target_unregister_timer_callback(&read_channel_callback, NULL);
 		rtt.source.stop(rtt.target, NULL);
 		return ret;
 	}
 
+	if (rtt.adaptive)
+		adapt_polling_interval();
+
 	return ERROR_OK;
 }
 
@@ -155,6 +265,9 @@ int rtt_start(void)
 	if (ret != ERROR_OK)
 		return ret;
 
+	memset(rtt.stats, 0, rtt.sink_list_length * sizeof(struct rtt_channel_stats));
+	rtt.start_time = timeval_ms();
+
 	target_register_timer_callback(&read_channel_callback,
 		rtt.polling_interval, 1, NULL);
 	rtt.started = true;
@@ -185,6 +298,8 @@ int rtt_stop(void)
 static int adjust_sink_list(size_t length)
 {
 	struct rtt_sink_list **tmp;
+	struct rtt_channel_stats *stats;
+	struct rtt_channel_read_result *results;
 
 	if (length <= rtt.sink_list_length)
 		return ERROR_OK;
@@ -194,10 +309,28 @@ static int adjust_sink_list(size_t length)
 	if (!tmp)
 		return ERROR_FAIL;
 
-	for (size_t i = rtt.sink_list_length; i < length; i++)
+	rtt.sink_list = tmp;
+
+	stats = realloc(rtt.stats, sizeof(struct rtt_channel_stats) * length);
+
+	if (!stats)
+		return ERROR_FAIL;
+
+	rtt.stats = stats;
+
+	results = realloc(rtt.results,
+		sizeof(struct rtt_channel_read_result) * length);
+
+	if (!results)
+		return ERROR_FAIL;
+
+	rtt.results = results;
+
+	for (size_t i = rtt.sink_list_length; i < length; i++) {
 		tmp[i] = NULL;
+		memset(&stats[i], 0, sizeof(struct rtt_channel_stats));
+	}
 
-	rtt.sink_list = tmp;
 	rtt.sink_list_length = length;
 
 	return ERROR_OK;
@@ -274,13 +407,60 @@ int rtt_set_polling_interval(unsigned int interval)
 	if (!interval)
 		return ERROR_FAIL;
 
-	if (rtt.polling_interval != interval) {
-		target_unregister_timer_callback(&read_channel_callback, NULL);
-		target_register_timer_callback(&read_channel_callback, interval, 1,
-			NULL);
+	/* A fixed polling interval overrides the adaptive one. */
+	rtt.adaptive = false;
+	rtt.polling_interval_fixed = interval;
+	change_polling_interval(interval);
+
+	return ERROR_OK;
+}
+
+int rtt_set_adaptive_polling(bool enable, unsigned int min_interval,
+		unsigned int max_interval)
+{
+	if (!enable) {
+		rtt.adaptive = false;
+		change_polling_interval(rtt.polling_interval_fixed);
+		return ERROR_OK;
 	}
 
-	rtt.polling_interval = interval;
+	if (!min_interval || min_interval > max_interval)
+		return ERROR_FAIL;
+
+	rtt.polling_interval_min = min_interval;
+	rtt.polling_interval_max = max_interval;
+	rtt.adaptive = true;
+
+	change_polling_interval(MIN(MAX(rtt.polling_interval, min_interval),
+		max_interval));
+
+	return ERROR_OK;
+}
+
+int rtt_get_adaptive_polling(bool *enable, unsigned int *min_interval,
+		unsigned int *max_interval)
+{
+	if (!enable || !min_interval || !max_interval)
+		return ERROR_FAIL;
+
+	*enable = rtt.adaptive;
+	*min_interval = rtt.polling_interval_min;
+	*max_interval = rtt.polling_interval_max;
+
+	return ERROR_OK;
+}
+
+int rtt_get_channel_stats(unsigned int channel_index,
+		struct rtt_channel_stats *stats, int64_t *elapsed)
+{
+	if (!stats || !elapsed)
+		return ERROR_FAIL;
+
+	if (channel_index >= rtt.sink_list_length)
+		return ERROR_FAIL;
+
+	*stats = rtt.stats[channel_index];
+	*elapsed = rtt.started ? timeval_ms() - rtt.start_time : 0;
 
 	return ERROR_OK;
 }
@@ -27,6 +27,24 @@
 /* Minimal channel buffer size in bytes. */
 #define RTT_CHANNEL_BUFFER_MIN_SIZE	2
 
+/* Maximal number of bytes read from a single channel per poll. */
+#define RTT_CHANNEL_READ_MAX_SIZE	(64 * 1024)
+
+/* Size of the memory chunks read while searching for the control block. */
+#define RTT_CB_SEARCH_CHUNK_SIZE	(64 * 1024)
+
+/*
+ * Up-channel fill level in percent above which the adaptive polling interval
+ * is shortened.
+ */
+#define RTT_FILL_LEVEL_HIGH	50
+
+/*
+ * Up-channel fill level in percent above which the target may already have
+ * dropped data or blocked.
+ */
+#define RTT_FILL_LEVEL_CRITICAL	90
+
 /** RTT control block. */
 struct rtt_control {
 	/** Control block address on the target. */
@@ -77,6 +95,33 @@ struct rtt_channel_info {
 	uint32_t flags;
 };
 
+/** RTT up-channel statistics. */
+struct rtt_channel_stats {
+	/** Number of bytes read from the channel. */
+	uint64_t bytes;
+	/** Fill level of the channel buffer at the last poll in percent. */
+	unsigned int fill_level;
+	/** Highest fill level of the channel buffer in percent. */
+	unsigned int max_fill_level;
+	/**
+	 * Number of polls that found the channel buffer above
+	 * RTT_FILL_LEVEL_CRITICAL, i.e. the target may have dropped data.
+	 */
+	uint32_t overflow_risk;
+};
+
+/** Result of a poll of an up-channel, reported by the RTT source. */
+struct rtt_channel_read_result {
+	/** Whether the channel was polled. */
+	bool polled;
+	/** Number of bytes pending in the channel buffer before the read. */
+	uint32_t pending;
+	/** Size of the channel buffer in bytes. */
+	uint32_t size;
+	/** Number of bytes read from the channel buffer. */
+	size_t length;
+};
+
 typedef int (*rtt_sink_read)(unsigned int channel, const uint8_t *buffer,
 		size_t length, void *user_data);
 
@@ -110,7 +155,8 @@ typedef int (*rtt_source_start)(struct target *target,
 typedef int (*rtt_source_stop)(struct target *target, void *user_data);
 typedef int (*rtt_source_read)(struct target *target,
 		const struct rtt_control *ctrl, struct rtt_sink_list **sinks,
-		size_t num_channels, void *user_data);
+		struct rtt_channel_read_result *results, size_t num_channels,
+		void *user_data);
 typedef int (*rtt_source_write)(struct target *target,
 		struct rtt_control *ctrl, unsigned int channel,
 		const uint8_t *buffer, size_t *length, void *user_data);
@@ -194,6 +240,45 @@ int rtt_get_polling_interval(unsigned int *interval);
  */
 int rtt_set_polling_interval(unsigned int interval);
 
+/**
+ * Enable or disable the adaptive polling interval.
+ *
+ * When enabled, the polling interval is shortened while the up-channels fill
+ * up and extended while they stay empty, within the given bounds.
+ *
+ * @param[in] enable Whether the adaptive polling interval is enabled.
+ * @param[in] min_interval Minimal polling interval in milliseconds.
+ * @param[in] max_interval Maximal polling interval in milliseconds.
+ *
+ * @returns ERROR_OK on success, an error code on failure.
+ */
+int rtt_set_adaptive_polling(bool enable, unsigned int min_interval,
+		unsigned int max_interval);
+
+/**
+ * Get the adaptive polling interval configuration.
+ *
+ * @param[out] enable Whether the adaptive polling interval is enabled.
+ * @param[out] min_interval Minimal polling interval in milliseconds.
+ * @param[out] max_interval Maximal polling interval in milliseconds.
+ *
+ * @returns ERROR_OK on success, an error code on failure.
+ */
+int rtt_get_adaptive_polling(bool *enable, unsigned int *min_interval,
+		unsigned int *max_interval);
+
+/**
+ * Get the statistics of an up-channel.
+ *
+ * @param[in] channel_index Channel index.
+ * @param[out] stats Channel statistics.
+ * @param[out] elapsed Time since RTT was started in milliseconds.
+ *
+ * @returns ERROR_OK on success, an error code on failure.
+ */
+int rtt_get_channel_stats(unsigned int channel_index,
+		struct rtt_channel_stats *stats, int64_t *elapsed);
+
 /**
  * Get whether RTT is started.
  *
@@ -97,6 +97,84 @@ COMMAND_HANDLER(handle_rtt_polling_interval_command)
 	return ERROR_OK;
 }
 
+COMMAND_HANDLER(handle_rtt_adaptive_polling_command)
+{
+	int ret;
+	bool enable;
+	unsigned int min_interval, max_interval;
+
+	if (CMD_ARGC == 0) {
+		ret = rtt_get_adaptive_polling(&enable, &min_interval, &max_interval);
+
+		if (ret != ERROR_OK) {
+			command_print(CMD, "Failed to get adaptive polling interval");
+			return ret;
+		}
+
+		if (enable)
+			command_print(CMD, "%u ms - %u ms", min_interval, max_interval);
+		else
+			command_print(CMD, "off");
+
+		return ERROR_OK;
+	}
+
+	if (CMD_ARGC == 1) {
+		if (strcmp(CMD_ARGV[0], "off"))
+			return ERROR_COMMAND_SYNTAX_ERROR;
+
+		return rtt_set_adaptive_polling(false, 0, 0);
+	}
+
+	if (CMD_ARGC != 2)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	COMMAND_PARSE_NUMBER(uint, CMD_ARGV[0], min_interval);
+	COMMAND_PARSE_NUMBER(uint, CMD_ARGV[1], max_interval);
+
+	ret = rtt_set_adaptive_polling(true, min_interval, max_interval);
+
+	if (ret != ERROR_OK) {
+		command_print(CMD, "Invalid polling interval bounds");
+		return ERROR_COMMAND_ARGUMENT_INVALID;
+	}
+
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_rtt_stats_command)
+{
+	const struct rtt_control *ctrl;
+
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (!rtt_found_cb()) {
+		command_print(CMD, "rtt: Control block not available");
+		return ERROR_FAIL;
+	}
+
+	ctrl = rtt_get_control();
+
+	for (unsigned int i = 0; i < ctrl->num_up_channels; i++) {
+		struct rtt_channel_stats stats;
+		int64_t elapsed;
+
+		/* Only channels with a sink are polled. */
+		if (rtt_get_channel_stats(i, &stats, &elapsed) != ERROR_OK)
+			break;
+
+		uint64_t rate = elapsed > 0 ? stats.bytes * 1000 / elapsed : 0;
+
+		command_print(CMD, "%u: %" PRIu64 " bytes, %" PRIu64 " bytes/s, "
+			"fill level %u%% (max %u%%), overflow risk %" PRIu32, i,
+			stats.bytes, rate, stats.fill_level, stats.max_fill_level,
+			stats.overflow_risk);
+	}
+
+	return ERROR_OK;
+}
+
 COMMAND_HANDLER(handle_rtt_channels_command)
 {
 	int ret;
@@ -241,6 +319,20 @@ static const struct command_registration rtt_subcommand_handlers[] = {
 		.help = "show or set polling interval in ms",
 		.usage = "[interval]"
 	},
+	{
+		.name = "adaptive_polling",
+		.handler = handle_rtt_adaptive_polling_command,
+		.mode = COMMAND_EXEC,
+		.help = "show, enable or disable the adaptive polling interval",
+		.usage = "['off' | min_interval max_interval]"
+	},
+	{
+		.name = "stats",
+		.handler = handle_rtt_stats_command,
+		.mode = COMMAND_EXEC,
+		.help = "show up-channel statistics",
+		.usage = ""
+	},
 	{
 		.name = "channels",
 		.handler = handle_rtt_channels_command,
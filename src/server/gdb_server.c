@@ -38,6 +38,7 @@
 #include "gdb_server.h"
 #include <target/image.h>
 #include <jtag/jtag.h>
+#include <helper/time_support.h>
 #include "rtos/rtos.h"
 #include "target/smp.h"
 
@@ -57,9 +58,40 @@ enum gdb_output_flag {
 	GDB_OUTPUT_ALL,
 };
 
-struct target_desc_format {
-	char *tdesc;
-	uint32_t tdesc_length;
+/* XML document served to GDB in chunks. The key is a fingerprint of the
+ * target state the document was generated from. */
+struct gdb_xml_document {
+	char *xml;
+	uint32_t length;
+	uint32_t key;
+};
+
+/* Target description and memory map of a target, kept across connections */
+struct gdb_xml_cache {
+	struct target *target;
+	struct gdb_xml_document tdesc;
+	struct gdb_xml_document memory_map;
+	struct gdb_xml_cache *next;
+};
+
+/* Output sent to GDB is collected here and handed to the socket in one
+ * write, so that a packet, its framing and any preceding ack or console
+ * output leave in a single segment. Large enough for a full packet. */
+#define GDB_OUT_BUFFER_SIZE (GDB_BUFFER_SIZE + 16)
+
+/* Flush queued output at least this often while a command is running */
+#define GDB_OUT_FLUSH_INTERVAL_MS 50
+
+/* traffic counters of a GDB connection, see 'gdb_statistics' */
+struct gdb_statistics {
+	uint64_t packets_in;
+	uint64_t packets_out;
+	uint64_t bytes_in;
+	uint64_t bytes_out;
+	uint64_t reads;
+	uint64_t writes;
+	uint64_t replies;
+	int64_t reply_time_ms;
 };
 
 /* private connection data for GDB */
@@ -67,6 +99,14 @@ struct gdb_connection {
 	char buffer[GDB_BUFFER_SIZE + 1]; /* Extra byte for null-termination */
 	char *buf_p;
 	int buf_cnt;
+	char out_buffer[GDB_OUT_BUFFER_SIZE];
+	int out_cnt;
+	/* set while input is processed, output is then flushed by gdb_input() */
+	bool defer_flush;
+	int64_t last_flush_ms;
+	/* arrival time of the packet not yet replied to, 0 if none */
+	int64_t request_ms;
+	struct gdb_statistics stats;
 	bool ctrl_c;
 	enum target_state frontend_state;
 	struct image *vflash_image;
@@ -89,8 +129,6 @@ struct gdb_connection {
 	bool attached;
 	/* set when extended protocol is used */
 	bool extended_protocol;
-	/* temporarily used for target description support */
-	struct target_desc_format target_desc;
 	/* temporarily used for thread list support */
 	char *thread_list;
 	/* flag to mask the output from gdb_log_callback() */
@@ -139,6 +177,7 @@ static int gdb_report_register_access_error;
  * via qXfer:features:read packet */
 /* enabled by default */
 static int gdb_use_target_description = 1;
+static struct gdb_xml_cache *gdb_xml_caches;
 
 /* current processing free-run type, used by file-I/O */
 static char gdb_running_type;
@@ -206,6 +245,8 @@ static int check_pending(struct connection *connection,
 	return ERROR_OK;
 }
 
+static int gdb_flush(struct connection *connection);
+
 static int gdb_get_char_inner(struct connection *connection, int *next_char)
 {
 	struct gdb_connection *gdb_con = connection->priv;
@@ -214,6 +255,11 @@ static int gdb_get_char_inner(struct connection *connection, int *next_char)
 #ifdef _DEBUG_GDB_IO_
 	char *debug_buffer;
 #endif
+	/* GDB can't answer what it has not received yet */
+	retval = gdb_flush(connection);
+	if (retval != ERROR_OK)
+		return retval;
+
 	for (;; ) {
 		if (connection->service->type != CONNECTION_TCP)
 			gdb_con->buf_cnt = read(connection->fd, gdb_con->buffer, GDB_BUFFER_SIZE);
@@ -225,9 +271,12 @@ static int gdb_get_char_inner(struct connection *connection, int *next_char)
 					gdb_con->buffer,
 					GDB_BUFFER_SIZE);
 		}
+		gdb_con->stats.reads++;
 
-		if (gdb_con->buf_cnt > 0)
+		if (gdb_con->buf_cnt > 0) {
+			gdb_con->stats.bytes_in += gdb_con->buf_cnt;
 			break;
+		}
 		if (gdb_con->buf_cnt == 0) {
 			LOG_DEBUG("GDB connection closed by the remote client");
 			gdb_con->closed = true;
@@ -329,7 +378,7 @@ static int gdb_putback_char(struct connection *connection, int last_char)
 /* The only way we can detect that the socket is closed is the first time
  * we write to it, we will fail. Subsequent write operations will
  * succeed. Shudder! */
-static int gdb_write(struct connection *connection, void *data, int len)
+static int gdb_write_direct(struct connection *connection, const void *data, int len)
 {
 	struct gdb_connection *gdb_con = connection->priv;
 	if (gdb_con->closed) {
@@ -337,14 +386,51 @@ static int gdb_write(struct connection *connection, void *data, int len)
 		return ERROR_SERVER_REMOTE_CLOSED;
 	}
 
-	if (connection_write(connection, data, len) == len)
+	gdb_con->stats.writes++;
+	if (connection_write(connection, data, len) == len) {
+		gdb_con->stats.bytes_out += len;
+		gdb_con->last_flush_ms = timeval_ms();
 		return ERROR_OK;
+	}
 
 	LOG_WARNING("Error writing to GDB socket. Dropping the connection.");
 	gdb_con->closed = true;
 	return ERROR_SERVER_REMOTE_CLOSED;
 }
 
+/* Send all output queued by gdb_write() */
+static int gdb_flush(struct connection *connection)
+{
+	struct gdb_connection *gdb_con = connection->priv;
+	if (gdb_con->out_cnt == 0)
+		return ERROR_OK;
+
+	int len = gdb_con->out_cnt;
+	gdb_con->out_cnt = 0;
+	return gdb_write_direct(connection, gdb_con->out_buffer, len);
+}
+
+/* Queue output for GDB. It is sent by gdb_flush(), at the latest before
+ * reading from GDB again or when the current input has been processed. */
+static int gdb_write(struct connection *connection, const void *data, int len)
+{
+	struct gdb_connection *gdb_con = connection->priv;
+	int retval;
+
+	if (gdb_con->out_cnt + len > GDB_OUT_BUFFER_SIZE) {
+		retval = gdb_flush(connection);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+
+	if (len > GDB_OUT_BUFFER_SIZE)
+		return gdb_write_direct(connection, data, len);
+
+	memcpy(gdb_con->out_buffer + gdb_con->out_cnt, data, len);
+	gdb_con->out_cnt += len;
+	return ERROR_OK;
+}
+
 static void gdb_log_incoming_packet(struct connection *connection, char *packet)
 {
 	if (!LOG_LEVEL_IS(LOG_LVL_DEBUG))
@@ -431,32 +517,22 @@ static int gdb_put_packet_inner(struct connection *connection,
 	}
 #endif
 
+	char trailer[4];
+	snprintf(trailer, sizeof(trailer), "#%02x", my_checksum);
+
 	while (1) {
 		gdb_log_outgoing_packet(connection, buffer, len, my_checksum);
 
-		char local_buffer[1024];
-		local_buffer[0] = '$';
-		if ((size_t)len + 4 <= sizeof(local_buffer)) {
-			/* performance gain on smaller packets by only a single call to gdb_write() */
-			memcpy(local_buffer + 1, buffer, len++);
-			len += snprintf(local_buffer + len, sizeof(local_buffer) - len, "#%02x", my_checksum);
-			retval = gdb_write(connection, local_buffer, len);
-			if (retval != ERROR_OK)
-				return retval;
-		} else {
-			/* larger packets are transmitted directly from caller supplied buffer
-			 * by several calls to gdb_write() to avoid dynamic allocation */
-			snprintf(local_buffer + 1, sizeof(local_buffer) - 1, "#%02x", my_checksum);
-			retval = gdb_write(connection, local_buffer, 1);
-			if (retval != ERROR_OK)
-				return retval;
-			retval = gdb_write(connection, buffer, len);
-			if (retval != ERROR_OK)
-				return retval;
-			retval = gdb_write(connection, local_buffer + 1, 3);
-			if (retval != ERROR_OK)
-				return retval;
-		}
+		/* the pieces are merged in the output buffer and leave in one write */
+		retval = gdb_write(connection, "$", 1);
+		if (retval != ERROR_OK)
+			return retval;
+		retval = gdb_write(connection, buffer, len);
+		if (retval != ERROR_OK)
+			return retval;
+		retval = gdb_write(connection, trailer, 3);
+		if (retval != ERROR_OK)
+			return retval;
 
 		if (gdb_con->noack_mode)
 			break;
@@ -520,8 +596,25 @@ int gdb_put_packet(struct connection *connection, char *buffer, int len)
 	int retval = gdb_put_packet_inner(connection, buffer, len);
 	gdb_con->busy = false;
 
-	/* we sent some data, reset timer for keep alive messages */
-	kept_alive();
+	gdb_con->stats.packets_out++;
+	int64_t now = timeval_ms();
+	if (gdb_con->request_ms) {
+		gdb_con->stats.replies++;
+		gdb_con->stats.reply_time_ms += now - gdb_con->request_ms;
+		gdb_con->request_ms = 0;
+	}
+
+	/* Within gdb_input() packets are collected and sent together when
+	 * the input has been processed, e.g. the console output of a monitor
+	 * command. Output of long running commands is sent along with further
+	 * output 50 ms after the last write, else by gdb_keep_client_alive(). */
+	if (retval == ERROR_OK && (!gdb_con->defer_flush ||
+			now - gdb_con->last_flush_ms >= GDB_OUT_FLUSH_INTERVAL_MS)) {
+		retval = gdb_flush(connection);
+
+		/* we sent some data, reset timer for keep alive messages */
+		kept_alive();
+	}
 
 	return retval;
 }
@@ -712,7 +805,10 @@ static int gdb_get_packet_inner(struct connection *connection,
 			break;
 		}
 		if (checksum_ok) {
+			/* acknowledge right away, the reply may take a while */
 			retval = gdb_write(connection, "+", 1);
+			if (retval == ERROR_OK)
+				retval = gdb_flush(connection);
 			if (retval != ERROR_OK)
 				return retval;
 			break;
@@ -730,6 +826,10 @@ static int gdb_get_packet(struct connection *connection, char *buffer, int *len)
 	gdb_con->busy = true;
 	int retval = gdb_get_packet_inner(connection, buffer, len);
 	gdb_con->busy = false;
+	if (retval == ERROR_OK) {
+		gdb_con->stats.packets_in++;
+		gdb_con->request_ms = timeval_ms();
+	}
 	return retval;
 }
 
@@ -989,10 +1089,13 @@ static int gdb_new_connection(struct connection *connection)
 	gdb_connection->mem_write_error = false;
 	gdb_connection->attached = true;
 	gdb_connection->extended_protocol = false;
-	gdb_connection->target_desc.tdesc = NULL;
-	gdb_connection->target_desc.tdesc_length = 0;
 	gdb_connection->thread_list = NULL;
 	gdb_connection->output_flag = GDB_OUTPUT_NO;
+	gdb_connection->out_cnt = 0;
+	gdb_connection->defer_flush = false;
+	gdb_connection->last_flush_ms = timeval_ms();
+	gdb_connection->request_ms = 0;
+	memset(&gdb_connection->stats, 0, sizeof(gdb_connection->stats));
 
 	/* send ACK to GDB for debug request */
 	gdb_write(connection, "+", 1);
@@ -1245,18 +1348,16 @@ static int gdb_get_registers_packet(struct connection *connection,
 
 	reg_packet_p = reg_packet;
 
+	retval = register_get_multiple(reg_list, reg_list_size);
+	if (retval != ERROR_OK && gdb_report_register_access_error) {
+		free(reg_packet);
+		free(reg_list);
+		return gdb_error(connection, retval);
+	}
+
 	for (i = 0; i < reg_list_size; i++) {
 		if (!reg_list[i] || reg_list[i]->exist == false || reg_list[i]->hidden)
 			continue;
-		if (!reg_list[i]->valid) {
-			retval = reg_list[i]->type->get(reg_list[i]);
-			if (retval != ERROR_OK && gdb_report_register_access_error) {
-				LOG_DEBUG("Couldn't get register %s.", reg_list[i]->name);
-				free(reg_packet);
-				free(reg_list);
-				return gdb_error(connection, retval);
-			}
-		}
 		gdb_str_to_target(target, reg_packet_p, reg_list[i]);
 		reg_packet_p += DIV_ROUND_UP(reg_list[i]->size, 8) * 2;
 	}
@@ -1841,6 +1942,66 @@ static __attribute__ ((format (PRINTF_ATTRIBUTE_FORMAT, 5, 6))) void xml_printf(
 	}
 }
 
+static struct gdb_xml_cache *gdb_get_xml_cache(struct target *target)
+{
+	struct gdb_xml_cache *cache;
+
+	for (cache = gdb_xml_caches; cache; cache = cache->next)
+		if (cache->target == target)
+			return cache;
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache) {
+		LOG_ERROR("Unable to allocate memory");
+		return NULL;
+	}
+	cache->target = target;
+	cache->next = gdb_xml_caches;
+	gdb_xml_caches = cache;
+
+	return cache;
+}
+
+static void gdb_set_xml_document(struct gdb_xml_document *doc, char *xml, uint32_t key)
+{
+	free(doc->xml);
+	doc->xml = xml;
+	doc->length = strlen(xml);
+	doc->key = key;
+}
+
+static void gdb_free_xml_caches(void)
+{
+	while (gdb_xml_caches) {
+		struct gdb_xml_cache *cache = gdb_xml_caches;
+		gdb_xml_caches = cache->next;
+		free(cache->tdesc.xml);
+		free(cache->memory_map.xml);
+		free(cache);
+	}
+}
+
+/* FNV-1a, used to fingerprint what the cached XML documents depend on */
+#define GDB_XML_KEY_INIT	2166136261u
+
+static uint32_t gdb_xml_key_add(uint32_t key, const void *data, size_t size)
+{
+	const uint8_t *p = data;
+
+	for (size_t i = 0; i < size; i++)
+		key = (key ^ p[i]) * 16777619u;
+	return key;
+}
+
+static uint32_t gdb_xml_key_add_str(uint32_t key, const char *str)
+{
+	if (!str)
+		return gdb_xml_key_add(key, &str, sizeof(str));
+	/* include the terminator, so that "ab","c" and "a","bc" differ */
+	return gdb_xml_key_add(key, str, strlen(str) + 1);
+}
+
+
 static int decode_xfer_read(char const *buf, char **annex, int *ofs, unsigned int *len)
 {
 	/* Locate the annex. */
@@ -1882,60 +2043,42 @@ static int compare_bank(const void *a, const void *b)
 		return -1;
 }
 
-static int gdb_memory_map(struct connection *connection,
-		char const *packet, int packet_size)
+static uint32_t gdb_memory_map_key(struct target *target, struct flash_bank **banks,
+		unsigned int num_banks)
 {
-	/* We get away with only specifying flash here. Regions that are not
-	 * specified are treated as if we provided no memory map(if not we
-	 * could detect the holes and mark them as RAM).
-	 * Normally we only execute this code once, but no big deal if we
-	 * have to regenerate it a couple of times.
-	 */
+	uint32_t key = GDB_XML_KEY_INIT;
+	target_addr_t address_max = target_address_max(target);
+
+	key = gdb_xml_key_add(key, &address_max, sizeof(address_max));
+	key = gdb_xml_key_add(key, &num_banks, sizeof(num_banks));
+	for (unsigned int i = 0; i < num_banks; i++) {
+		struct flash_bank *p = banks[i];
+		key = gdb_xml_key_add(key, &p, sizeof(p));
+		key = gdb_xml_key_add(key, &p->base, sizeof(p->base));
+		key = gdb_xml_key_add(key, &p->size, sizeof(p->size));
+		key = gdb_xml_key_add(key, &p->num_sectors, sizeof(p->num_sectors));
+		for (unsigned int j = 0; j < p->num_sectors; j++) {
+			key = gdb_xml_key_add(key, &p->sectors[j].offset, sizeof(p->sectors[j].offset));
+			key = gdb_xml_key_add(key, &p->sectors[j].size, sizeof(p->sectors[j].size));
+		}
+	}
 
-	struct target *target = get_target_from_connection(connection);
+	return key;
+}
+
+static int gdb_generate_memory_map(struct target *target, struct flash_bank **banks,
+		unsigned int num_banks, char **xml_out)
+{
 	struct flash_bank *p;
 	char *xml = NULL;
 	int size = 0;
 	int pos = 0;
 	int retval = ERROR_OK;
-	struct flash_bank **banks;
-	int offset;
-	int length;
-	char *separator;
 	target_addr_t ram_start = 0;
-	unsigned int target_flash_banks = 0;
-
-	/* skip command character */
-	packet += 23;
-
-	offset = strtoul(packet, &separator, 16);
-	length = strtoul(separator + 1, &separator, 16);
 
 	xml_printf(&retval, &xml, &pos, &size, "<memory-map>\n");
 
-	/* Sort banks in ascending order.  We need to report non-flash
-	 * memory as ram (or rather read/write) by default for GDB, since
-	 * it has no concept of non-cacheable read/write memory (i/o etc).
-	 */
-	banks = malloc(sizeof(struct flash_bank *)*flash_get_bank_count());
-
-	for (unsigned int i = 0; i < flash_get_bank_count(); i++) {
-		p = get_flash_bank_by_num_noprobe(i);
-		if (p->target != target)
-			continue;
-		retval = get_flash_bank_by_num(i, &p);
-		if (retval != ERROR_OK) {
-			free(banks);
-			gdb_error(connection, retval);
-			return retval;
-		}
-		banks[target_flash_banks++] = p;
-	}
-
-	qsort(banks, target_flash_banks, sizeof(struct flash_bank *),
-		compare_bank);
-
-	for (unsigned int i = 0; i < target_flash_banks; i++) {
+	for (unsigned int i = 0; i < num_banks; i++) {
 		unsigned sector_size = 0;
 		unsigned group_len = 0;
 
@@ -2006,26 +2149,95 @@ static int gdb_memory_map(struct connection *connection,
 	/* ELSE a flash chip could be at the very end of the address space, in
 	 * which case ram_start will be precisely 0 */
 
-	free(banks);
-
 	xml_printf(&retval, &xml, &pos, &size, "</memory-map>\n");
 
-	if (retval != ERROR_OK) {
+	if (retval == ERROR_OK)
+		*xml_out = xml;
+	else
 		free(xml);
-		gdb_error(connection, retval);
-		return retval;
+
+	return retval;
+}
+
+static int gdb_memory_map(struct connection *connection,
+		char const *packet, int packet_size)
+{
+	/* We get away with only specifying flash here. Regions that are not
+	 * specified are treated as if we provided no memory map(if not we
+	 * could detect the holes and mark them as RAM).
+	 * The map is generated once and kept until the flash banks of the
+	 * target change, as GDB asks for it on every connection.
+	 */
+
+	struct target *target = get_target_from_connection(connection);
+	struct flash_bank *p;
+	int retval = ERROR_OK;
+	struct flash_bank **banks;
+	int offset;
+	int length;
+	char *separator;
+	unsigned int target_flash_banks = 0;
+
+	/* skip command character */
+	packet += 23;
+
+	offset = strtoul(packet, &separator, 16);
+	length = strtoul(separator + 1, &separator, 16);
+
+	struct gdb_xml_cache *cache = gdb_get_xml_cache(target);
+	if (!cache) {
+		gdb_error(connection, ERROR_FAIL);
+		return ERROR_FAIL;
+	}
+
+	/* Sort banks in ascending order.  We need to report non-flash
+	 * memory as ram (or rather read/write) by default for GDB, since
+	 * it has no concept of non-cacheable read/write memory (i/o etc).
+	 */
+	banks = malloc(sizeof(struct flash_bank *)*flash_get_bank_count());
+
+	for (unsigned int i = 0; i < flash_get_bank_count(); i++) {
+		p = get_flash_bank_by_num_noprobe(i);
+		if (p->target != target)
+			continue;
+		retval = get_flash_bank_by_num(i, &p);
+		if (retval != ERROR_OK) {
+			free(banks);
+			gdb_error(connection, retval);
+			return retval;
+		}
+		banks[target_flash_banks++] = p;
+	}
+
+	qsort(banks, target_flash_banks, sizeof(struct flash_bank *),
+		compare_bank);
+
+	struct gdb_xml_document *map = &cache->memory_map;
+	uint32_t key = gdb_memory_map_key(target, banks, target_flash_banks);
+	if (!map->xml || map->key != key) {
+		char *xml;
+		retval = gdb_generate_memory_map(target, banks, target_flash_banks, &xml);
+		if (retval != ERROR_OK) {
+			free(banks);
+			gdb_error(connection, retval);
+			return retval;
+		}
+		gdb_set_xml_document(map, xml, key);
 	}
 
-	if (offset + length > pos)
-		length = pos - offset;
+	free(banks);
+
+	if (offset < 0 || (uint32_t)offset > map->length)
+		offset = map->length;
+	if ((uint32_t)(offset + length) > map->length)
+		length = map->length - offset;
 
 	char *t = malloc(length + 1);
 	t[0] = 'l';
-	memcpy(t + 1, xml + offset, length);
+	memcpy(t + 1, map->xml + offset, length);
 	gdb_put_packet(connection, t, length + 1);
 
 	free(t);
-	free(xml);
 	return ERROR_OK;
 }
 
@@ -2529,30 +2741,83 @@ error:
 	return retval;
 }
 
-static int gdb_get_target_description_chunk(struct target *target, struct target_desc_format *target_desc,
+/*
+ * Fingerprint of everything gdb_generate_target_description() reads, cheap
+ * compared to generating the XML for targets with many registers.
+ */
+static int gdb_target_description_key(struct target *target, uint32_t *key_out)
+{
+	struct reg **reg_list = NULL;
+	int reg_list_size;
+
+	int retval = smp_reg_list_noread(target, &reg_list, &reg_list_size,
+			REG_CLASS_ALL);
+	if (retval != ERROR_OK) {
+		LOG_ERROR("get register list failed");
+		return ERROR_FAIL;
+	}
+
+	uint32_t key = GDB_XML_KEY_INIT;
+	key = gdb_xml_key_add_str(key, target_get_gdb_arch(target));
+	key = gdb_xml_key_add(key, &reg_list_size, sizeof(reg_list_size));
+	for (int i = 0; i < reg_list_size; i++) {
+		const struct reg *reg = reg_list[i];
+		key = gdb_xml_key_add(key, &reg, sizeof(reg));
+		if (!reg)
+			continue;
+		key = gdb_xml_key_add_str(key, reg->name);
+		key = gdb_xml_key_add(key, &reg->number, sizeof(reg->number));
+		key = gdb_xml_key_add(key, &reg->size, sizeof(reg->size));
+		key = gdb_xml_key_add(key, &reg->exist, sizeof(reg->exist));
+		key = gdb_xml_key_add(key, &reg->hidden, sizeof(reg->hidden));
+		key = gdb_xml_key_add(key, &reg->caller_save, sizeof(reg->caller_save));
+		key = gdb_xml_key_add_str(key, reg->feature ? reg->feature->name : NULL);
+		key = gdb_xml_key_add_str(key, reg->group);
+		key = gdb_xml_key_add(key, &reg->reg_data_type, sizeof(reg->reg_data_type));
+	}
+	free(reg_list);
+
+	*key_out = key;
+	return ERROR_OK;
+}
+
+static int gdb_get_target_description_chunk(struct target *target,
 		char **chunk, int32_t offset, uint32_t length)
 {
-	if (!target_desc) {
+	struct gdb_xml_cache *cache = gdb_get_xml_cache(target);
+	if (!cache) {
 		LOG_ERROR("Unable to Generate Target Description");
 		return ERROR_FAIL;
 	}
 
-	char *tdesc = target_desc->tdesc;
-	uint32_t tdesc_length = target_desc->tdesc_length;
+	struct gdb_xml_document *tdesc = &cache->tdesc;
 
-	if (!tdesc) {
-		int retval = gdb_generate_target_description(target, &tdesc);
+	/* GDB reads the description from the start, check the cache only then */
+	if (offset == 0 || !tdesc->xml) {
+		uint32_t key;
+		int retval = gdb_target_description_key(target, &key);
 		if (retval != ERROR_OK) {
 			LOG_ERROR("Unable to Generate Target Description");
 			return ERROR_FAIL;
 		}
 
-		tdesc_length = strlen(tdesc);
+		if (!tdesc->xml || tdesc->key != key) {
+			char *xml;
+			retval = gdb_generate_target_description(target, &xml);
+			if (retval != ERROR_OK) {
+				LOG_ERROR("Unable to Generate Target Description");
+				return ERROR_FAIL;
+			}
+			gdb_set_xml_document(tdesc, xml, key);
+		}
 	}
 
+	if (offset < 0 || (uint32_t)offset > tdesc->length)
+		offset = tdesc->length;
+
 	char transfer_type;
 
-	if (length < (tdesc_length - offset))
+	if (length < (tdesc->length - offset))
 		transfer_type = 'm';
 	else
 		transfer_type = 'l';
@@ -2565,21 +2830,13 @@ static int gdb_get_target_description_chunk(struct target *target, struct target
 
 	(*chunk)[0] = transfer_type;
 	if (transfer_type == 'm') {
-		strncpy((*chunk) + 1, tdesc + offset, length);
+		strncpy((*chunk) + 1, tdesc->xml + offset, length);
 		(*chunk)[1 + length] = '\0';
 	} else {
-		strncpy((*chunk) + 1, tdesc + offset, tdesc_length - offset);
-		(*chunk)[1 + (tdesc_length - offset)] = '\0';
-
-		/* After gdb-server sends out last chunk, invalidate tdesc. */
-		free(tdesc);
-		tdesc = NULL;
-		tdesc_length = 0;
+		strncpy((*chunk) + 1, tdesc->xml + offset, tdesc->length - offset);
+		(*chunk)[1 + (tdesc->length - offset)] = '\0';
 	}
 
-	target_desc->tdesc = tdesc;
-	target_desc->tdesc_length = tdesc_length;
-
 	return ERROR_OK;
 }
 
@@ -2906,8 +3163,7 @@ static int gdb_query_packet(struct connection *connection,
 		 * there are *more* chunks to transfer. 'l' for it is the *last*
 		 * chunk of target description.
 		 */
-		retval = gdb_get_target_description_chunk(target, &gdb_connection->target_desc,
-				&xml, offset, length);
+		retval = gdb_get_target_description_chunk(target, &xml, offset, length);
 		if (retval != ERROR_OK) {
 			gdb_error(connection, retval);
 			return retval;
@@ -3718,11 +3974,17 @@ static int gdb_input_inner(struct connection *connection)
 
 static int gdb_input(struct connection *connection)
 {
-	int retval = gdb_input_inner(connection);
 	struct gdb_connection *gdb_con = connection->priv;
+	gdb_con->defer_flush = true;
+	int retval = gdb_input_inner(connection);
+	gdb_con->defer_flush = false;
 	if (retval == ERROR_SERVER_REMOTE_CLOSED)
 		return retval;
 
+	/* send the replies collected while processing the input */
+	if (gdb_flush(connection) != ERROR_OK)
+		return ERROR_SERVER_REMOTE_CLOSED;
+
 	/* logging does not propagate the error, yet can set the gdb_con->closed flag */
 	if (gdb_con->closed)
 		return ERROR_SERVER_REMOTE_CLOSED;
@@ -3751,6 +4013,10 @@ static void gdb_keep_client_alive(struct connection *connection)
 	default:
 		break;
 	}
+
+	/* the packet above may have been queued with output of a running
+	 * command, send them now */
+	gdb_flush(connection);
 }
 
 static const struct service_driver gdb_service_driver = {
@@ -3879,6 +4145,31 @@ COMMAND_HANDLER(handle_gdb_sync_command)
 	return ERROR_OK;
 }
 
+COMMAND_HANDLER(handle_gdb_statistics_command)
+{
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (!current_gdb_connection) {
+		command_print(CMD,
+			"gdb_statistics command can only be run from within gdb using \"monitor gdb_statistics\"");
+		return ERROR_FAIL;
+	}
+
+	const struct gdb_statistics *stats = &current_gdb_connection->stats;
+	command_print(CMD, "packets received: %" PRIu64 ", sent: %" PRIu64,
+		stats->packets_in, stats->packets_out);
+	command_print(CMD, "bytes received: %" PRIu64 ", sent: %" PRIu64,
+		stats->bytes_in, stats->bytes_out);
+	command_print(CMD, "socket reads: %" PRIu64 ", writes: %" PRIu64,
+		stats->reads, stats->writes);
+	if (stats->replies)
+		command_print(CMD, "average reply latency: %.3f ms",
+			(double)stats->reply_time_ms / stats->replies);
+
+	return ERROR_OK;
+}
+
 /* daemon configuration command gdb_port */
 COMMAND_HANDLER(handle_gdb_port_command)
 {
@@ -4013,6 +4304,14 @@ static const struct command_registration gdb_command_handlers[] = {
 			"target state",
 		.usage = ""
 	},
+	{
+		.name = "gdb_statistics",
+		.handler = handle_gdb_statistics_command,
+		.mode = COMMAND_EXEC,
+		.help = "show packet and socket traffic counters of the "
+			"current GDB connection",
+		.usage = ""
+	},
 	{
 		.name = "gdb_port",
 		.handler = handle_gdb_port_command,
@@ -4090,6 +4389,7 @@ void gdb_service_free(void)
 {
 	free(gdb_port);
 	free(gdb_port_next);
+	gdb_free_xml_caches();
 }
 
 int gdb_get_actual_connections(void)
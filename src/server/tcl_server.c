@@ -16,6 +16,20 @@
 #define TCL_SERVER_VERSION		"TCL Server 0.1"
 #define TCL_LINE_INITIAL		(4*1024)
 #define TCL_LINE_MAX			(4*1024*1024)
+#define TCL_READ_SIZE			(64*1024)
+
+/* Binary framing, see 'tcl_binary'. A frame is a type byte followed by the
+ * payload length as 32-bit little endian and the payload. */
+#define TCL_FRAME_HEADER_SIZE	5
+#define TCL_FRAME_COMMAND		'C'	/* Tcl command line */
+#define TCL_FRAME_READ			'r'	/* 64-bit address, 64-bit byte count */
+#define TCL_FRAME_WRITE			'w'	/* 64-bit address, data */
+#define TCL_FRAME_RESULT		'R'	/* success, command result */
+#define TCL_FRAME_ERROR			'E'	/* failure, error message */
+#define TCL_FRAME_DATA			'D'	/* part of the memory read */
+#define TCL_FRAME_NOTIFY		'N'	/* asynchronous notification */
+/* memory is transferred to and from the target in chunks of this size */
+#define TCL_FRAME_CHUNK			(64*1024)
 
 struct tcl_connection {
 	int tc_linedrop;
@@ -26,6 +40,17 @@ struct tcl_connection {
 	enum target_state tc_laststate;
 	bool tc_notify;
 	bool tc_trace;
+	/* binary framing */
+	bool tc_binary;
+	uint8_t tc_frame_header[TCL_FRAME_HEADER_SIZE];
+	unsigned int tc_frame_header_len;
+	uint32_t tc_frame_len;		/* payload bytes still to receive */
+	uint8_t tc_frame_args[16];	/* fixed size arguments of read/write */
+	unsigned int tc_frame_args_len;
+	target_addr_t tc_frame_addr;	/* next address written by a write frame */
+	int tc_frame_retval;		/* first error of the current frame */
+	uint8_t *tc_chunk;			/* frame header plus TCL_FRAME_CHUNK bytes */
+	unsigned int tc_chunk_len;
 };
 
 static char *tcl_port;
@@ -35,6 +60,7 @@ static int tcl_new_connection(struct connection *connection);
 static int tcl_input(struct connection *connection);
 static int tcl_output(struct connection *connection, const void *buf, ssize_t len);
 static int tcl_closed(struct connection *connection);
+static int tcl_output_notification(struct connection *connection, const char *buf);
 
 static int tcl_target_callback_event_handler(struct target *target,
 		enum target_event event, void *priv)
@@ -47,14 +73,14 @@ static int tcl_target_callback_event_handler(struct target *target,
 
 	if (tclc->tc_notify) {
 		snprintf(buf, sizeof(buf), "type target_event event %s\r\n\x1a", target_event_name(event));
-		tcl_output(connection, buf, strlen(buf));
+		tcl_output_notification(connection, buf);
 	}
 
 	if (tclc->tc_laststate != target->state) {
 		tclc->tc_laststate = target->state;
 		if (tclc->tc_notify) {
 			snprintf(buf, sizeof(buf), "type target_state state %s\r\n\x1a", target_state_name(target));
-			tcl_output(connection, buf, strlen(buf));
+			tcl_output_notification(connection, buf);
 		}
 	}
 
@@ -72,7 +98,7 @@ static int tcl_target_callback_reset_handler(struct target *target,
 
 	if (tclc->tc_notify) {
 		snprintf(buf, sizeof(buf), "type target_reset mode %s\r\n\x1a", target_reset_mode_name(reset_mode));
-		tcl_output(connection, buf, strlen(buf));
+		tcl_output_notification(connection, buf);
 	}
 
 	return ERROR_OK;
@@ -96,7 +122,7 @@ static int tcl_target_callback_trace_handler(struct target *target,
 		buf = malloc(max_len);
 		hexify(hex, data, len, hex_len);
 		snprintf(buf, max_len, "%s%s%s", header, hex, trailer);
-		tcl_output(connection, buf, strlen(buf));
+		tcl_output_notification(connection, buf);
 		free(hex);
 		free(buf);
 	}
@@ -160,32 +186,30 @@ static int tcl_new_connection(struct connection *connection)
 	return ERROR_OK;
 }
 
-static int tcl_input(struct connection *connection)
+/* Run the command collected in tc_line. The result is left in the interpreter. */
+static int tcl_run_line(struct connection *connection)
+{
+	struct tcl_connection *tclc = connection->priv;
+
+	tclc->tc_line[tclc->tc_lineoffset] = '\0';
+	return command_run_line(connection->cmd_ctx, tclc->tc_line);
+}
+
+/* Consume text input up to and including the end of the first command line */
+static int tcl_line_input(struct connection *connection, const unsigned char *in,
+		size_t len, size_t *consumed)
 {
 	Jim_Interp *interp = (Jim_Interp *)connection->cmd_ctx->interp;
+	struct tcl_connection *tclc = connection->priv;
 	int retval;
-	int i;
-	ssize_t rlen;
+	size_t i;
 	const char *result;
 	int reslen;
-	struct tcl_connection *tclc;
-	unsigned char in[256];
 	char *tc_line_new;
 	int tc_line_size_new;
 
-	rlen = connection_read(connection, &in, sizeof(in));
-	if (rlen <= 0) {
-		if (rlen < 0)
-			LOG_ERROR("error during read: %s", strerror(errno));
-		return ERROR_SERVER_REMOTE_CLOSED;
-	}
-
-	tclc = connection->priv;
-	if (!tclc)
-		return ERROR_CONNECTION_REJECTED;
-
 	/* push as much data into the line as possible */
-	for (i = 0; i < rlen; i++) {
+	for (i = 0; i < len; i++) {
 		/* buffer the data */
 		tclc->tc_line[tclc->tc_lineoffset] = in[i];
 		if (tclc->tc_lineoffset + 1 < tclc->tc_line_size) {
@@ -229,8 +253,8 @@ static int tcl_input(struct connection *connection)
 				return retval;
 #undef ESTR
 		} else {
-			tclc->tc_line[tclc->tc_lineoffset-1] = '\0';
-			command_run_line(connection->cmd_ctx, tclc->tc_line);
+			tclc->tc_lineoffset--;
+			tcl_run_line(connection);
 			result = Jim_GetString(Jim_GetResult(interp), &reslen);
 			retval = tcl_output(connection, result, reslen);
 			if (retval != ERROR_OK)
@@ -241,6 +265,309 @@ static int tcl_input(struct connection *connection)
 
 		tclc->tc_lineoffset = 0;
 		tclc->tc_linedrop = 0;
+
+		/* the command may have switched to binary framing */
+		*consumed = i + 1;
+		return ERROR_OK;
+	}
+
+	*consumed = len;
+	return ERROR_OK;
+}
+
+static int tcl_output_frame(struct connection *connection, uint8_t type,
+		const void *data, uint32_t len)
+{
+	uint8_t header[TCL_FRAME_HEADER_SIZE];
+
+	header[0] = type;
+	h_u32_to_le(header + 1, len);
+	int retval = tcl_output(connection, header, sizeof(header));
+	if (retval == ERROR_OK && len)
+		retval = tcl_output(connection, data, len);
+	return retval;
+}
+
+static int tcl_output_error_frame(struct connection *connection, const char *msg)
+{
+	return tcl_output_frame(connection, TCL_FRAME_ERROR, msg, strlen(msg));
+}
+
+/* Send notifications and trace data in the framing the client expects */
+static int tcl_output_notification(struct connection *connection, const char *buf)
+{
+	struct tcl_connection *tclc = connection->priv;
+	size_t len = strlen(buf);
+
+	if (!tclc->tc_binary)
+		return tcl_output(connection, buf, len);
+
+	/* frames are delimited by their length, drop the ctrl-z */
+	if (len && buf[len - 1] == '\x1a')
+		len--;
+	return tcl_output_frame(connection, TCL_FRAME_NOTIFY, buf, len);
+}
+
+/* Write the data collected in tc_chunk to the target */
+static void tcl_frame_write_chunk(struct connection *connection)
+{
+	struct tcl_connection *tclc = connection->priv;
+
+	if (!tclc->tc_chunk_len)
+		return;
+
+	if (tclc->tc_frame_retval == ERROR_OK) {
+		struct target *target = get_current_target_or_null(connection->cmd_ctx);
+		if (!target)
+			tclc->tc_frame_retval = ERROR_FAIL;
+		else
+			tclc->tc_frame_retval = target_write_buffer(target, tclc->tc_frame_addr,
+				tclc->tc_chunk_len, tclc->tc_chunk + TCL_FRAME_HEADER_SIZE);
+		if (tclc->tc_frame_retval == ERROR_OK)
+			tclc->tc_frame_addr += tclc->tc_chunk_len;
+	}
+	tclc->tc_chunk_len = 0;
+}
+
+static void tcl_frame_start(struct connection *connection)
+{
+	struct tcl_connection *tclc = connection->priv;
+
+	tclc->tc_frame_len = le_to_h_u32(tclc->tc_frame_header + 1);
+	tclc->tc_frame_args_len = 0;
+	tclc->tc_frame_retval = ERROR_OK;
+	tclc->tc_chunk_len = 0;
+	tclc->tc_lineoffset = 0;
+	tclc->tc_linedrop = 0;
+
+	switch (tclc->tc_frame_header[0]) {
+	case TCL_FRAME_COMMAND:
+		if (tclc->tc_frame_len >= TCL_LINE_MAX) {
+			tclc->tc_linedrop = 1;
+		} else if (tclc->tc_frame_len >= (uint32_t)tclc->tc_line_size) {
+			char *tc_line_new = realloc(tclc->tc_line, tclc->tc_frame_len + 1);
+			if (!tc_line_new) {
+				tclc->tc_linedrop = 1;
+			} else {
+				tclc->tc_line = tc_line_new;
+				tclc->tc_line_size = tclc->tc_frame_len + 1;
+			}
+		}
+		break;
+	case TCL_FRAME_READ:
+	case TCL_FRAME_WRITE:
+		if (!tclc->tc_chunk) {
+			tclc->tc_chunk = malloc(TCL_FRAME_HEADER_SIZE + TCL_FRAME_CHUNK);
+			if (!tclc->tc_chunk)
+				tclc->tc_frame_retval = ERROR_FAIL;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/* Consume up to len bytes of frame payload */
+static void tcl_frame_payload(struct connection *connection, const uint8_t *data, size_t len)
+{
+	struct tcl_connection *tclc = connection->priv;
+	unsigned int args_size;
+	size_t n;
+
+	switch (tclc->tc_frame_header[0]) {
+	case TCL_FRAME_COMMAND:
+		if (!tclc->tc_linedrop) {
+			memcpy(tclc->tc_line + tclc->tc_lineoffset, data, len);
+			tclc->tc_lineoffset += len;
+		}
+		return;
+	case TCL_FRAME_READ:
+		args_size = 16;
+		break;
+	case TCL_FRAME_WRITE:
+		args_size = 8;
+		break;
+	default:
+		return;
+	}
+
+	if (tclc->tc_frame_args_len < args_size) {
+		n = MIN(len, args_size - tclc->tc_frame_args_len);
+		memcpy(tclc->tc_frame_args + tclc->tc_frame_args_len, data, n);
+		tclc->tc_frame_args_len += n;
+		data += n;
+		len -= n;
+		if (tclc->tc_frame_args_len == args_size)
+			tclc->tc_frame_addr = le_to_h_u64(tclc->tc_frame_args);
+	}
+	if (!len)
+		return;
+
+	if (tclc->tc_frame_header[0] == TCL_FRAME_READ) {
+		/* read frames carry nothing but their arguments */
+		tclc->tc_frame_args_len = args_size + 1;
+		return;
+	}
+
+	if (!tclc->tc_chunk || tclc->tc_frame_retval != ERROR_OK)
+		return;
+
+	while (len) {
+		n = MIN(len, TCL_FRAME_CHUNK - tclc->tc_chunk_len);
+		memcpy(tclc->tc_chunk + TCL_FRAME_HEADER_SIZE + tclc->tc_chunk_len, data, n);
+		tclc->tc_chunk_len += n;
+		data += n;
+		len -= n;
+		if (tclc->tc_chunk_len == TCL_FRAME_CHUNK)
+			tcl_frame_write_chunk(connection);
+	}
+}
+
+static int tcl_frame_read(struct connection *connection)
+{
+	struct tcl_connection *tclc = connection->priv;
+	struct target *target = get_current_target_or_null(connection->cmd_ctx);
+	char msg[80];
+
+	if (tclc->tc_frame_args_len != 16)
+		return tcl_output_error_frame(connection, "malformed read frame");
+	if (!target)
+		return tcl_output_error_frame(connection, "no current target");
+	if (!tclc->tc_chunk)
+		return tcl_output_error_frame(connection, "out of memory");
+
+	target_addr_t addr = le_to_h_u64(tclc->tc_frame_args);
+	uint64_t count = le_to_h_u64(tclc->tc_frame_args + 8);
+	if (count && addr + (count - 1) < addr)
+		return tcl_output_error_frame(connection, "address range wraps");
+
+	while (count) {
+		uint32_t n = MIN(count, TCL_FRAME_CHUNK);
+		int retval = target_read_buffer(target, addr, n, tclc->tc_chunk + TCL_FRAME_HEADER_SIZE);
+		if (retval != ERROR_OK) {
+			snprintf(msg, sizeof(msg), "read failed at address " TARGET_ADDR_FMT, addr);
+			return tcl_output_error_frame(connection, msg);
+		}
+
+		/* the header goes in front of the data to send both in one go */
+		tclc->tc_chunk[0] = TCL_FRAME_DATA;
+		h_u32_to_le(tclc->tc_chunk + 1, n);
+		retval = tcl_output(connection, tclc->tc_chunk, TCL_FRAME_HEADER_SIZE + n);
+		if (retval != ERROR_OK)
+			return retval;
+
+		addr += n;
+		count -= n;
+	}
+
+	return tcl_output_frame(connection, TCL_FRAME_RESULT, NULL, 0);
+}
+
+static int tcl_frame_end(struct connection *connection)
+{
+	Jim_Interp *interp = (Jim_Interp *)connection->cmd_ctx->interp;
+	struct tcl_connection *tclc = connection->priv;
+	const char *result;
+	int reslen;
+	char msg[80];
+	int retval;
+
+	switch (tclc->tc_frame_header[0]) {
+	case TCL_FRAME_COMMAND:
+		if (tclc->tc_linedrop) {
+			retval = tcl_output_error_frame(connection, "line too long");
+		} else {
+			int cmd_retval = tcl_run_line(connection);
+			result = Jim_GetString(Jim_GetResult(interp), &reslen);
+			retval = tcl_output_frame(connection,
+				cmd_retval == ERROR_OK ? TCL_FRAME_RESULT : TCL_FRAME_ERROR,
+				result, reslen);
+		}
+		tclc->tc_lineoffset = 0;
+		tclc->tc_linedrop = 0;
+		return retval;
+	case TCL_FRAME_READ:
+		return tcl_frame_read(connection);
+	case TCL_FRAME_WRITE:
+		if (tclc->tc_frame_args_len != 8)
+			return tcl_output_error_frame(connection, "malformed write frame");
+		tcl_frame_write_chunk(connection);
+		if (tclc->tc_frame_retval == ERROR_OK)
+			return tcl_output_frame(connection, TCL_FRAME_RESULT, NULL, 0);
+		if (!tclc->tc_chunk)
+			return tcl_output_error_frame(connection, "out of memory");
+		if (!get_current_target_or_null(connection->cmd_ctx))
+			return tcl_output_error_frame(connection, "no current target");
+		snprintf(msg, sizeof(msg), "write failed at address " TARGET_ADDR_FMT,
+			tclc->tc_frame_addr);
+		return tcl_output_error_frame(connection, msg);
+	default:
+		snprintf(msg, sizeof(msg), "unknown frame type 0x%02x", tclc->tc_frame_header[0]);
+		return tcl_output_error_frame(connection, msg);
+	}
+}
+
+/* Consume binary input up to and including the end of the first frame */
+static int tcl_binary_input(struct connection *connection, const unsigned char *in,
+		size_t len, size_t *consumed)
+{
+	struct tcl_connection *tclc = connection->priv;
+	size_t done = 0;
+	size_t n;
+
+	if (tclc->tc_frame_header_len < TCL_FRAME_HEADER_SIZE) {
+		n = MIN(len, TCL_FRAME_HEADER_SIZE - tclc->tc_frame_header_len);
+		memcpy(tclc->tc_frame_header + tclc->tc_frame_header_len, in, n);
+		tclc->tc_frame_header_len += n;
+		done = n;
+		if (tclc->tc_frame_header_len < TCL_FRAME_HEADER_SIZE) {
+			*consumed = done;
+			return ERROR_OK;
+		}
+		tcl_frame_start(connection);
+	}
+
+	n = MIN(len - done, tclc->tc_frame_len);
+	tcl_frame_payload(connection, in + done, n);
+	tclc->tc_frame_len -= n;
+	done += n;
+	*consumed = done;
+
+	if (tclc->tc_frame_len)
+		return ERROR_OK;
+
+	tclc->tc_frame_header_len = 0;
+	return tcl_frame_end(connection);
+}
+
+static int tcl_input(struct connection *connection)
+{
+	/* Do not allocate this on the stack */
+	static unsigned char in[TCL_READ_SIZE];
+	int retval;
+	ssize_t rlen;
+	size_t done, consumed;
+	struct tcl_connection *tclc;
+
+	rlen = connection_read(connection, in, sizeof(in));
+	if (rlen <= 0) {
+		if (rlen < 0)
+			LOG_ERROR("error during read: %s", strerror(errno));
+		return ERROR_SERVER_REMOTE_CLOSED;
+	}
+
+	tclc = connection->priv;
+	if (!tclc)
+		return ERROR_CONNECTION_REJECTED;
+
+	/* a command can switch the framing, check it again after each one */
+	for (done = 0; done < (size_t)rlen; done += consumed) {
+		if (tclc->tc_binary)
+			retval = tcl_binary_input(connection, in + done, rlen - done, &consumed);
+		else
+			retval = tcl_line_input(connection, in + done, rlen - done, &consumed);
+		if (retval != ERROR_OK)
+			return retval;
 	}
 
 	return ERROR_OK;
@@ -254,6 +581,7 @@ static int tcl_closed(struct connection *connection)
 	/* cleanup connection context */
 	if (tclc) {
 		free(tclc->tc_line);
+		free(tclc->tc_chunk);
 		free(tclc);
 		connection->priv = NULL;
 	}
@@ -323,6 +651,23 @@ COMMAND_HANDLER(handle_tcl_trace_command)
 	}
 }
 
+COMMAND_HANDLER(handle_tcl_binary_command)
+{
+	struct connection *connection = NULL;
+	struct tcl_connection *tclc = NULL;
+
+	if (CMD_CTX->output_handler_priv)
+		connection = CMD_CTX->output_handler_priv;
+
+	if (connection && !strcmp(connection->service->name, "tcl")) {
+		tclc = connection->priv;
+		return CALL_COMMAND_HANDLER(handle_command_parse_bool, &tclc->tc_binary, "Binary framing ");
+	} else {
+		LOG_ERROR("%s: can only be called from the tcl server", CMD_NAME);
+		return ERROR_COMMAND_SYNTAX_ERROR;
+	}
+}
+
 static const struct command_registration tcl_command_handlers[] = {
 	{
 		.name = "tcl_port",
@@ -347,6 +692,13 @@ static const struct command_registration tcl_command_handlers[] = {
 		.help = "Target trace output",
 		.usage = "[on|off]",
 	},
+	{
+		.name = "tcl_binary",
+		.handler = handle_tcl_binary_command,
+		.mode = COMMAND_EXEC,
+		.help = "Binary framing of commands, results and memory transfers",
+		.usage = "[on|off]",
+	},
 	COMMAND_REGISTRATION_DONE
 };
 
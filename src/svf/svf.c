@@ -201,9 +201,11 @@ struct svf_check_tdo_para {
 	int bit_len;		/* bit length to check */
 };
 
+/* initial number of scans whose TDO check can be queued, doubled as needed */
 #define SVF_CHECK_TDO_PARA_SIZE 1024
 static struct svf_check_tdo_para *svf_check_tdo_para;
 static int svf_check_tdo_para_index;
+static int svf_check_tdo_para_size;
 
 static int svf_read_command_from_file(FILE *fd);
 static int svf_check_tdo(void);
@@ -219,7 +221,14 @@ static size_t svf_command_buffer_size;
 static int svf_line_number;
 static int svf_getline(char **lineptr, size_t *n, FILE *stream);
 
+/* the file is read in large blocks, svf_getline() splits them into lines */
+#define SVF_FILE_BUFFER_SIZE	(256 * 1024)
+static char *svf_file_buffer;
+static size_t svf_file_buffer_pos, svf_file_buffer_len;
+
 #define SVF_MAX_BUFFER_SIZE_TO_COMMIT   (1024 * 1024)
+/* number of scans queued before the queue is executed and TDO is checked */
+#define SVF_MAX_SCANS_TO_COMMIT         (8 * 1024)
 static uint8_t *svf_tdi_buffer, *svf_tdo_buffer, *svf_mask_buffer;
 static int svf_buffer_index, svf_buffer_size;
 static int svf_quiet;
@@ -238,6 +247,150 @@ static long svf_total_lines;
 static int svf_percentage;
 static int svf_last_printed_percentage = -1;
 
+/*
+ * Compiled SVF cache
+ *
+ * With "-cache", the JTAG operations queued while an SVF file is parsed are
+ * recorded in a binary file next to it ("<file>.svfc"). The cache is keyed
+ * by a hash of the SVF text and of the options that change the queued
+ * operations, so later runs of the same file replay the recorded scans,
+ * state moves and waits straight into the JTAG queue without parsing the
+ * text again. All values are stored little endian.
+ */
+#define SVF_CACHE_MAGIC			"OCDSVFC"
+#define SVF_CACHE_VERSION		1
+#define SVF_CACHE_SUFFIX		".svfc"
+#define SVF_CACHE_HEADER_SIZE	32
+
+enum svf_cache_op {
+	SVF_CACHE_OP_END,
+	SVF_CACHE_OP_TLR,		/* no arguments */
+	SVF_CACHE_OP_PATHMOVE,	/* u32 num_states, u8 states[] */
+	SVF_CACHE_OP_IR_SCAN,	/* u8 end_state, u8 check, u32 line, u32 num_bits, tdi [, tdo, mask] */
+	SVF_CACHE_OP_DR_SCAN,	/* same as SVF_CACHE_OP_IR_SCAN */
+	SVF_CACHE_OP_CLOCKS,	/* u32 num_cycles */
+	SVF_CACHE_OP_SLEEP,		/* u32 us */
+	SVF_CACHE_OP_RESET,		/* u8 trst */
+	SVF_CACHE_OP_EXECUTE,	/* no arguments, flush queue and check TDO */
+	SVF_CACHE_OP_FREQUENCY,	/* u32 kHz */
+};
+
+static bool svf_cache_enabled;
+static char *svf_cache_path;
+/* non-NULL only while recording the cache */
+static FILE *svf_cache_fd;
+static bool svf_cache_write_error;
+static uint64_t svf_cache_read_count;
+
+static void svf_cache_write(const void *data, size_t len)
+{
+	if (!svf_cache_fd || svf_cache_write_error)
+		return;
+	if (fwrite(data, 1, len, svf_cache_fd) != len)
+		svf_cache_write_error = true;
+}
+
+static void svf_cache_write_u8(uint8_t val)
+{
+	svf_cache_write(&val, 1);
+}
+
+static void svf_cache_write_u32(uint32_t val)
+{
+	uint8_t buf[4];
+
+	h_u32_to_le(buf, val);
+	svf_cache_write(buf, sizeof(buf));
+}
+
+static bool svf_cache_read(FILE *fd, void *data, size_t len)
+{
+	if (fread(data, 1, len, fd) != len)
+		return false;
+	svf_cache_read_count += len;
+	return true;
+}
+
+static bool svf_cache_read_u8(FILE *fd, uint8_t *val)
+{
+	return svf_cache_read(fd, val, 1);
+}
+
+static bool svf_cache_read_u32(FILE *fd, uint32_t *val)
+{
+	uint8_t buf[4];
+
+	if (!svf_cache_read(fd, buf, sizeof(buf)))
+		return false;
+	*val = le_to_h_u32(buf);
+	return true;
+}
+
+/* The helpers below queue JTAG operations and record them in the cache */
+static void svf_queue_tlr(void)
+{
+	svf_cache_write_u8(SVF_CACHE_OP_TLR);
+	if (!svf_nil)
+		jtag_add_tlr();
+}
+
+static void svf_queue_pathmove(int num_states, const tap_state_t *path)
+{
+	if (svf_cache_fd) {
+		svf_cache_write_u8(SVF_CACHE_OP_PATHMOVE);
+		svf_cache_write_u32(num_states);
+		for (int i = 0; i < num_states; i++)
+			svf_cache_write_u8(path[i]);
+	}
+	if (!svf_nil)
+		jtag_add_pathmove(num_states, path);
+}
+
+static void svf_queue_clocks(int num_cycles)
+{
+	svf_cache_write_u8(SVF_CACHE_OP_CLOCKS);
+	svf_cache_write_u32(num_cycles);
+	if (!svf_nil)
+		jtag_add_clocks(num_cycles);
+}
+
+static void svf_queue_sleep(uint32_t us)
+{
+	svf_cache_write_u8(SVF_CACHE_OP_SLEEP);
+	svf_cache_write_u32(us);
+	if (!svf_nil)
+		jtag_add_sleep(us);
+}
+
+static void svf_queue_reset(int trst)
+{
+	svf_cache_write_u8(SVF_CACHE_OP_RESET);
+	svf_cache_write_u8(trst);
+	if (!svf_nil)
+		jtag_add_reset(trst, 0);
+}
+
+/* Record a scan whose data was assembled at svf_buffer_index */
+static void svf_cache_record_scan(enum svf_cache_op op, int num_bits, bool check,
+		tap_state_t end_state)
+{
+	int len = (num_bits + 7) >> 3;
+
+	if (!svf_cache_fd)
+		return;
+
+	svf_cache_write_u8(op);
+	svf_cache_write_u8(end_state);
+	svf_cache_write_u8(check);
+	svf_cache_write_u32(svf_line_number);
+	svf_cache_write_u32(num_bits);
+	svf_cache_write(&svf_tdi_buffer[svf_buffer_index], len);
+	if (check) {
+		svf_cache_write(&svf_tdo_buffer[svf_buffer_index], len);
+		svf_cache_write(&svf_mask_buffer[svf_buffer_index], len);
+	}
+}
+
 /*
  * macro is used to print the svf hex buffer at desired debug level
  * DEBUG, INFO, ERROR, USER
@@ -323,7 +476,7 @@ int svf_add_statemove(tap_state_t state_to)
 		if (svf_nil)
 			return ERROR_OK;
 
-		jtag_add_tlr();
+		svf_queue_tlr();
 		return ERROR_OK;
 	}
 
@@ -335,10 +488,10 @@ int svf_add_statemove(tap_state_t state_to)
 						/* recorded path includes current state ... avoid
 						 *extra TCKs! */
 			if (svf_statemoves[index_var].num_of_moves > 1)
-				jtag_add_pathmove(svf_statemoves[index_var].num_of_moves - 1,
+				svf_queue_pathmove(svf_statemoves[index_var].num_of_moves - 1,
 					svf_statemoves[index_var].paths + 1);
 			else
-				jtag_add_pathmove(svf_statemoves[index_var].num_of_moves,
+				svf_queue_pathmove(svf_statemoves[index_var].num_of_moves,
 					svf_statemoves[index_var].paths);
 			return ERROR_OK;
 		}
@@ -347,8 +500,247 @@ int svf_add_statemove(tap_state_t state_to)
 	return ERROR_FAIL;
 }
 
+static uint64_t svf_cache_hash(uint64_t hash, const uint8_t *data, size_t len)
+{
+	/* FNV-1a */
+	for (size_t i = 0; i < len; i++)
+		hash = (hash ^ data[i]) * 0x100000001b3ull;
+	return hash;
+}
+
+/* Hash the SVF text and the parameters that change the queued operations */
+static int svf_cache_compute_key(FILE *fd, uint64_t *key)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	const uint32_t params[] = {
+		SVF_CACHE_VERSION,
+		svf_noreset,
+		svf_addcycles,
+		svf_tap_is_specified,
+		svf_para.hir_para.len,
+		svf_para.hdr_para.len,
+		svf_para.tir_para.len,
+		svf_para.tdr_para.len,
+		cmd_queue_cur_state,
+	};
+	uint8_t buf[4];
+	size_t len;
+
+	while ((len = fread(svf_file_buffer, 1, SVF_FILE_BUFFER_SIZE, fd)) > 0)
+		hash = svf_cache_hash(hash, (const uint8_t *)svf_file_buffer, len);
+	if (ferror(fd)) {
+		LOG_ERROR("failed to read svf file");
+		return ERROR_FAIL;
+	}
+	rewind(fd);
+	svf_file_buffer_pos = 0;
+	svf_file_buffer_len = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(params); i++) {
+		h_u32_to_le(buf, params[i]);
+		hash = svf_cache_hash(hash, buf, sizeof(buf));
+	}
+
+	*key = hash;
+	return ERROR_OK;
+}
+
+/* Open the cache if it is complete and matches @a key, return NULL otherwise */
+static FILE *svf_cache_open(uint64_t key, uint64_t *size, int *command_num)
+{
+	uint8_t header[SVF_CACHE_HEADER_SIZE];
+	FILE *fd;
+	long file_size;
+
+	fd = fopen(svf_cache_path, "rb");
+	if (!fd)
+		return NULL;
+	setvbuf(fd, NULL, _IOFBF, SVF_FILE_BUFFER_SIZE);
+
+	if (fread(header, 1, sizeof(header), fd) != sizeof(header) ||
+			memcmp(header, SVF_CACHE_MAGIC, sizeof(SVF_CACHE_MAGIC)) ||
+			le_to_h_u32(header + 8) != SVF_CACHE_VERSION ||
+			le_to_h_u64(header + 16) != key)
+		goto stale;
+
+	*command_num = le_to_h_u32(header + 12);
+	*size = le_to_h_u64(header + 24);
+
+	if (fseek(fd, 0, SEEK_END) != 0)
+		goto stale;
+	file_size = ftell(fd);
+	if (file_size < 0 || (uint64_t)file_size != *size ||
+			fseek(fd, SVF_CACHE_HEADER_SIZE, SEEK_SET) != 0)
+		goto stale;
+
+	return fd;
+
+stale:
+	LOG_DEBUG("svf cache \"%s\" is stale", svf_cache_path);
+	fclose(fd);
+	return NULL;
+}
+
+/* Replay the operations of a cache, @a corrupted tells a damaged cache
+ * apart from failures of the operations themselves */
+static int svf_cache_replay(struct command_context *cmd_ctx, FILE *fd, uint64_t size,
+		bool *corrupted)
+{
+	tap_state_t path[256];
+	uint8_t op, u8, check;
+	uint32_t val, num_bits;
+	uint8_t *buf;
+	int len;
+
+	svf_cache_read_count = SVF_CACHE_HEADER_SIZE;
+	*corrupted = false;
+
+	while (svf_cache_read_u8(fd, &op)) {
+		switch (op) {
+		case SVF_CACHE_OP_END:
+			return ERROR_OK;
+		case SVF_CACHE_OP_TLR:
+			jtag_add_tlr();
+			break;
+		case SVF_CACHE_OP_PATHMOVE:
+			if (!svf_cache_read_u32(fd, &val) || val > ARRAY_SIZE(path))
+				goto corrupted;
+			for (uint32_t i = 0; i < val; i++) {
+				if (!svf_cache_read_u8(fd, &u8))
+					goto corrupted;
+				path[i] = u8;
+			}
+			jtag_add_pathmove(val, path);
+			break;
+		case SVF_CACHE_OP_IR_SCAN:
+		case SVF_CACHE_OP_DR_SCAN:
+			if (!svf_cache_read_u8(fd, &u8) || !svf_cache_read_u8(fd, &check) ||
+					!svf_cache_read_u32(fd, &val) || !svf_cache_read_u32(fd, &num_bits) ||
+					num_bits > INT_MAX - 7)
+				goto corrupted;
+			svf_line_number = val;
+			len = (num_bits + 7) >> 3;
+			if ((svf_buffer_size - svf_buffer_index) < len) {
+				if (svf_realloc_buffers(svf_buffer_index + len) != ERROR_OK) {
+					LOG_ERROR("not enough memory");
+					return ERROR_FAIL;
+				}
+			}
+			buf = &svf_tdi_buffer[svf_buffer_index];
+			if (!svf_cache_read(fd, buf, len))
+				goto corrupted;
+			if (check && (!svf_cache_read(fd, &svf_tdo_buffer[svf_buffer_index], len) ||
+					!svf_cache_read(fd, &svf_mask_buffer[svf_buffer_index], len)))
+				goto corrupted;
+			if (svf_add_check_para(check, svf_buffer_index, num_bits) != ERROR_OK)
+				return ERROR_FAIL;
+			if (op == SVF_CACHE_OP_IR_SCAN)
+				jtag_add_plain_ir_scan(num_bits, buf, check ? buf : NULL, u8);
+			else
+				jtag_add_plain_dr_scan(num_bits, buf, check ? buf : NULL, u8);
+			svf_buffer_index += len;
+			break;
+		case SVF_CACHE_OP_CLOCKS:
+			if (!svf_cache_read_u32(fd, &val))
+				goto corrupted;
+			jtag_add_clocks(val);
+			break;
+		case SVF_CACHE_OP_SLEEP:
+			if (!svf_cache_read_u32(fd, &val))
+				goto corrupted;
+			jtag_add_sleep(val);
+			break;
+		case SVF_CACHE_OP_RESET:
+			if (!svf_cache_read_u8(fd, &u8))
+				goto corrupted;
+			jtag_add_reset(u8, 0);
+			break;
+		case SVF_CACHE_OP_EXECUTE:
+			if (svf_execute_tap() != ERROR_OK)
+				return ERROR_FAIL;
+			break;
+		case SVF_CACHE_OP_FREQUENCY:
+			if (!svf_cache_read_u32(fd, &val))
+				goto corrupted;
+			command_run_linef(cmd_ctx, "adapter speed %d", (int)val);
+			break;
+		default:
+			goto corrupted;
+		}
+
+		if (svf_progress_enabled) {
+			svf_percentage = ((svf_cache_read_count * 20) / size) * 5;
+			if (svf_last_printed_percentage != svf_percentage) {
+				LOG_USER_N("\r%d%%    ", svf_percentage);
+				svf_last_printed_percentage = svf_percentage;
+			}
+		}
+	}
+
+corrupted:
+	LOG_ERROR("svf cache \"%s\" is corrupted", svf_cache_path);
+	*corrupted = true;
+	return ERROR_FAIL;
+}
+
+static void svf_cache_create(uint64_t key)
+{
+	uint8_t header[SVF_CACHE_HEADER_SIZE] = { 0 };
+
+	svf_cache_fd = fopen(svf_cache_path, "wb");
+	if (!svf_cache_fd) {
+		LOG_WARNING("can not create svf cache \"%s\": %s", svf_cache_path, strerror(errno));
+		return;
+	}
+	setvbuf(svf_cache_fd, NULL, _IOFBF, SVF_FILE_BUFFER_SIZE);
+
+	memcpy(header, SVF_CACHE_MAGIC, sizeof(SVF_CACHE_MAGIC));
+	h_u32_to_le(header + 8, SVF_CACHE_VERSION);
+	h_u64_to_le(header + 16, key);
+	svf_cache_write_error = false;
+	svf_cache_write(header, sizeof(header));
+}
+
+/* Complete the cache being recorded, it is discarded if the run failed */
+static void svf_cache_finish(bool success, int command_num)
+{
+	uint8_t buf[8];
+	long size;
+
+	if (!svf_cache_fd)
+		return;
+
+	if (success) {
+		svf_cache_write_u8(SVF_CACHE_OP_END);
+		size = ftell(svf_cache_fd);
+		if (size < 0 || fseek(svf_cache_fd, 12, SEEK_SET) != 0) {
+			svf_cache_write_error = true;
+		} else {
+			svf_cache_write_u32(command_num);
+			h_u64_to_le(buf, size);
+			if (fseek(svf_cache_fd, 24, SEEK_SET) != 0)
+				svf_cache_write_error = true;
+			svf_cache_write(buf, sizeof(buf));
+		}
+	}
+
+	if (fclose(svf_cache_fd) != 0)
+		svf_cache_write_error = true;
+	svf_cache_fd = NULL;
+
+	if (success && !svf_cache_write_error) {
+		LOG_INFO("svf cache written to \"%s\"", svf_cache_path);
+		return;
+	}
+
+	if (success)
+		LOG_WARNING("failed to write svf cache \"%s\"", svf_cache_path);
+	remove(svf_cache_path);
+}
+
 enum svf_cmd_param {
 	OPT_ADDCYCLES,
+	OPT_CACHE,
 	OPT_IGNORE_ERROR,
 	OPT_NIL,
 	OPT_NORESET,
@@ -364,6 +756,7 @@ enum svf_cmd_param {
 
 static const struct nvp svf_cmd_opts[] = {
 	{ .name = "-addcycles",    .value = OPT_ADDCYCLES },
+	{ .name = "-cache",        .value = OPT_CACHE },
 	{ .name = "-ignore_error", .value = OPT_IGNORE_ERROR },
 	{ .name = "-nil",          .value = OPT_NIL },
 	{ .name = "-noreset",      .value = OPT_NORESET },
@@ -381,11 +774,13 @@ static const struct nvp svf_cmd_opts[] = {
 COMMAND_HANDLER(handle_svf_command)
 {
 #define SVF_MIN_NUM_OF_OPTIONS 1
-#define SVF_MAX_NUM_OF_OPTIONS 8
+#define SVF_MAX_NUM_OF_OPTIONS 9
 	int command_num = 0;
 	int ret = ERROR_OK;
 	int64_t time_measure_ms;
 	int time_measure_s, time_measure_m;
+	FILE *cache_fd = NULL;
+	uint64_t cache_key, cache_size;
 
 	/*
 	 * use NULL to indicate a "plain" svf file which accounts for
@@ -404,6 +799,7 @@ COMMAND_HANDLER(handle_svf_command)
 	svf_ignore_error = 0;
 	svf_noreset = false;
 	svf_addcycles = 0;
+	svf_cache_enabled = false;
 
 	for (unsigned int i = 0; i < CMD_ARGC; i++) {
 		const struct nvp *n = nvp_name2value(svf_cmd_opts, CMD_ARGV[i]);
@@ -464,6 +860,10 @@ COMMAND_HANDLER(handle_svf_command)
 			svf_noreset = true;
 			break;
 
+		case OPT_CACHE:
+			svf_cache_enabled = true;
+			break;
+
 		default:
 			svf_fd = fopen(CMD_ARGV[i], "r");
 			if (!svf_fd) {
@@ -473,6 +873,8 @@ COMMAND_HANDLER(handle_svf_command)
 				return ERROR_COMMAND_SYNTAX_ERROR;
 			}
 			LOG_USER("svf processing file: \"%s\"", CMD_ARGV[i]);
+			free(svf_cache_path);
+			svf_cache_path = alloc_printf("%s" SVF_CACHE_SUFFIX, CMD_ARGV[i]);
 			break;
 		}
 	}
@@ -487,8 +889,18 @@ COMMAND_HANDLER(handle_svf_command)
 	svf_line_number = 0;
 	svf_command_buffer_size = 0;
 
+	svf_file_buffer_pos = 0;
+	svf_file_buffer_len = 0;
+	svf_file_buffer = malloc(SVF_FILE_BUFFER_SIZE);
+	if (!svf_file_buffer) {
+		LOG_ERROR("not enough memory");
+		ret = ERROR_FAIL;
+		goto free_all;
+	}
+
 	svf_check_tdo_para_index = 0;
-	svf_check_tdo_para = malloc(sizeof(struct svf_check_tdo_para) * SVF_CHECK_TDO_PARA_SIZE);
+	svf_check_tdo_para_size = SVF_CHECK_TDO_PARA_SIZE;
+	svf_check_tdo_para = malloc(sizeof(struct svf_check_tdo_para) * svf_check_tdo_para_size);
 	if (!svf_check_tdo_para) {
 		LOG_ERROR("not enough memory");
 		ret = ERROR_FAIL;
@@ -560,44 +972,105 @@ COMMAND_HANDLER(handle_svf_command)
 		}
 	}
 
-	if (svf_progress_enabled) {
-		/* Count total lines in file. */
-		while (!feof(svf_fd)) {
-			svf_getline(&svf_command_buffer, &svf_command_buffer_size, svf_fd);
-			svf_total_lines++;
+	if (svf_cache_enabled && !svf_nil) {
+		if (!svf_cache_path) {
+			LOG_ERROR("not enough memory");
+			ret = ERROR_FAIL;
+			goto free_all;
 		}
-		rewind(svf_fd);
+		ret = svf_cache_compute_key(svf_fd, &cache_key);
+		if (ret != ERROR_OK)
+			goto free_all;
+		cache_fd = svf_cache_open(cache_key, &cache_size, &command_num);
+		if (!cache_fd)
+			svf_cache_create(cache_key);
 	}
-	while (svf_read_command_from_file(svf_fd) == ERROR_OK) {
-		/* Log Output */
-		if (svf_quiet) {
-			if (svf_progress_enabled) {
-				svf_percentage = ((svf_line_number * 20) / svf_total_lines) * 5;
-				if (svf_last_printed_percentage != svf_percentage) {
-					LOG_USER_N("\r%d%%    ", svf_percentage);
-					svf_last_printed_percentage = svf_percentage;
-				}
-			}
+
+	bool replayed = false;
+	if (cache_fd) {
+		int ignore_error = svf_ignore_error;
+		bool corrupted;
+
+		/* skip text parsing, replay the compiled operations */
+		LOG_USER("svf replaying cache: \"%s\"", svf_cache_path);
+		ret = svf_cache_replay(CMD_CTX, cache_fd, cache_size, &corrupted);
+		fclose(cache_fd);
+
+		/* run what is still queued even after a failure, then check it */
+		if (jtag_execute_queue() != ERROR_OK)
+			ret = ERROR_FAIL;
+		else if (ret == ERROR_OK)
+			ret = svf_check_tdo();
+
+		if (!corrupted) {
+			/* TDO mismatches and JTAG errors are the result of the run */
+			replayed = true;
 		} else {
-			if (svf_progress_enabled) {
-				svf_percentage = ((svf_line_number * 20) / svf_total_lines) * 5;
-				LOG_USER_N("%3d%%  %s", svf_percentage, svf_read_line);
-			} else
-				LOG_USER_N("%s", svf_read_line);
+			/* A damaged cache would fail every later run the same way,
+			 * drop it and start over from the svf file. */
+			LOG_WARNING("svf cache \"%s\" replay failed, removing it and "
+				"processing the svf file", svf_cache_path);
+			if (remove(svf_cache_path) != 0)
+				LOG_WARNING("can not remove svf cache \"%s\": %s",
+					svf_cache_path, strerror(errno));
+
+			svf_line_number = 0;
+			svf_buffer_index = 0;
+			svf_check_tdo_para_index = 0;
+			svf_ignore_error = ignore_error;
+			command_num = 0;
+			ret = ERROR_OK;
+
+			if (!svf_noreset)
+				jtag_add_tlr();
+			svf_cache_create(cache_key);
 		}
-		/* Run Command */
-		if (svf_run_command(CMD_CTX, svf_command_buffer) != ERROR_OK) {
-			LOG_ERROR("fail to run command at line %d", svf_line_number);
-			ret = ERROR_FAIL;
-			break;
+	}
+
+	if (!replayed) {
+		if (svf_progress_enabled) {
+			/* Count total lines in file. */
+			do {
+				svf_total_lines++;
+			} while (svf_getline(&svf_command_buffer, &svf_command_buffer_size, svf_fd) > 0);
+			rewind(svf_fd);
+			svf_file_buffer_pos = 0;
+			svf_file_buffer_len = 0;
+		}
+		while (svf_read_command_from_file(svf_fd) == ERROR_OK) {
+			/* Log Output */
+			if (svf_quiet) {
+				if (svf_progress_enabled) {
+					svf_percentage = ((svf_line_number * 20) / svf_total_lines) * 5;
+					if (svf_last_printed_percentage != svf_percentage) {
+						LOG_USER_N("\r%d%%    ", svf_percentage);
+						svf_last_printed_percentage = svf_percentage;
+					}
+				}
+			} else {
+				if (svf_progress_enabled) {
+					svf_percentage = ((svf_line_number * 20) / svf_total_lines) * 5;
+					LOG_USER_N("%3d%%  %s", svf_percentage, svf_read_line);
+				} else
+					LOG_USER_N("%s", svf_read_line);
+			}
+			/* Run Command */
+			if (svf_run_command(CMD_CTX, svf_command_buffer) != ERROR_OK) {
+				LOG_ERROR("fail to run command at line %d", svf_line_number);
+				ret = ERROR_FAIL;
+				break;
+			}
+			command_num++;
 		}
-		command_num++;
 	}
 
-	if ((!svf_nil) && (jtag_execute_queue() != ERROR_OK))
-		ret = ERROR_FAIL;
-	else if (svf_check_tdo() != ERROR_OK)
-		ret = ERROR_FAIL;
+	/* a replay has been executed and checked already */
+	if (!replayed) {
+		if ((!svf_nil) && (jtag_execute_queue() != ERROR_OK))
+			ret = ERROR_FAIL;
+		else if (svf_check_tdo() != ERROR_OK)
+			ret = ERROR_FAIL;
+	}
 
 	/* print time */
 	time_measure_ms = timeval_ms() - time_measure_ms;
@@ -614,10 +1087,19 @@ COMMAND_HANDLER(handle_svf_command)
 
 free_all:
 
+	svf_cache_finish(ret == ERROR_OK, command_num);
+	free(svf_cache_path);
+	svf_cache_path = NULL;
+
 	fclose(svf_fd);
 	svf_fd = NULL;
 
 	/* free buffers */
+	free(svf_file_buffer);
+	svf_file_buffer = NULL;
+	svf_file_buffer_pos = 0;
+	svf_file_buffer_len = 0;
+
 	free(svf_command_buffer);
 	svf_command_buffer = NULL;
 	svf_command_buffer_size = 0;
@@ -625,6 +1107,7 @@ free_all:
 	free(svf_check_tdo_para);
 	svf_check_tdo_para = NULL;
 	svf_check_tdo_para_index = 0;
+	svf_check_tdo_para_size = 0;
 
 	free(svf_tdi_buffer);
 	svf_tdi_buffer = NULL;
@@ -660,7 +1143,7 @@ free_all:
 
 static int svf_getline(char **lineptr, size_t *n, FILE *stream)
 {
-#define MIN_CHUNK 16	/* Buffer is increased by this size each time as required */
+#define MIN_CHUNK 16	/* Initial buffer size, doubled each time as required */
 	size_t i = 0;
 
 	if (!*lineptr) {
@@ -670,22 +1153,42 @@ static int svf_getline(char **lineptr, size_t *n, FILE *stream)
 			return -1;
 	}
 
-	(*lineptr)[0] = fgetc(stream);
-	while ((*lineptr)[i] != '\n') {
-		(*lineptr)[++i] = fgetc(stream);
-		if (feof(stream)) {
-			(*lineptr)[0] = 0;
-			return -1;
+	while (true) {
+		if (svf_file_buffer_pos == svf_file_buffer_len) {
+			svf_file_buffer_pos = 0;
+			svf_file_buffer_len = fread(svf_file_buffer, 1, SVF_FILE_BUFFER_SIZE, stream);
+			if (!svf_file_buffer_len) {
+				/* an unterminated last line is dropped */
+				(*lineptr)[0] = 0;
+				return -1;
+			}
 		}
-		if ((i + 2) > *n) {
-			*n += MIN_CHUNK;
-			*lineptr = realloc(*lineptr, *n);
+
+		const char *start = svf_file_buffer + svf_file_buffer_pos;
+		size_t avail = svf_file_buffer_len - svf_file_buffer_pos;
+		const char *eol = memchr(start, '\n', avail);
+		size_t len = eol ? (size_t)(eol - start) + 1 : avail;
+
+		if (i + len + 1 > *n) {
+			size_t new_size = MAX(*n * 2, i + len + 1);
+			char *tmp = realloc(*lineptr, new_size);
+			if (!tmp)
+				return -1;
+			*lineptr = tmp;
+			*n = new_size;
 		}
+
+		memcpy(*lineptr + i, start, len);
+		i += len;
+		svf_file_buffer_pos += len;
+
+		if (eol)
+			break;
 	}
 
-	(*lineptr)[++i] = 0;
+	(*lineptr)[i] = 0;
 
-	return sizeof(*lineptr);
+	return i;
 }
 
 #define SVFP_CMD_INC_CNT 1024
@@ -749,12 +1252,15 @@ static int svf_read_command_from_file(FILE *fd)
 				 *  - terminating NUL ('\0')
 				 */
 				if (cmd_pos + 3 > svf_command_buffer_size) {
-					svf_command_buffer = realloc(svf_command_buffer, cmd_pos + 3);
-					svf_command_buffer_size = cmd_pos + 3;
-					if (!svf_command_buffer) {
+					size_t new_size = MAX(cmd_pos + 3,
+						MAX(2 * svf_command_buffer_size, SVFP_CMD_INC_CNT));
+					char *tmp = realloc(svf_command_buffer, new_size);
+					if (!tmp) {
 						LOG_ERROR("not enough memory");
 						return ERROR_FAIL;
 					}
+					svf_command_buffer = tmp;
+					svf_command_buffer_size = new_size;
 				}
 
 				/* insert a space before '(' */
@@ -875,7 +1381,17 @@ static int svf_copy_hexstring_to_binary(char *str, uint8_t **bin, int orig_bit_l
 	for (i = 0; i < str_hbyte_len; i++) {
 		ch = 0;
 		while (str_len > 0) {
-			ch = str[--str_len];
+			char c = str[--str_len];
+
+			/* the command buffer is upper case, hex digits are the
+			 * common case and are checked first */
+			if ((c >= '0') && (c <= '9')) {
+				ch = c - '0';
+				break;
+			} else if ((c >= 'A') && (c <= 'F')) {
+				ch = c - 'A' + 10;
+				break;
+			}
 
 			/* Skip whitespace.  The SVF specification (rev E) is
 			 * deficient in terms of basic lexical issues like
@@ -883,20 +1399,10 @@ static int svf_copy_hexstring_to_binary(char *str, uint8_t **bin, int orig_bit_l
 			 * require line ends for correctness, since there is
 			 * a hard limit on line length.
 			 */
-			if (!isspace(ch)) {
-				if ((ch >= '0') && (ch <= '9')) {
-					ch = ch - '0';
-					break;
-				} else if ((ch >= 'A') && (ch <= 'F')) {
-					ch = ch - 'A' + 10;
-					break;
-				} else {
-					LOG_ERROR("invalid hex string");
-					return ERROR_FAIL;
-				}
+			if (!isspace((unsigned char) c)) {
+				LOG_ERROR("invalid hex string");
+				return ERROR_FAIL;
 			}
-
-			ch = 0;
 		}
 
 		/* write bin */
@@ -905,8 +1411,7 @@ static int svf_copy_hexstring_to_binary(char *str, uint8_t **bin, int orig_bit_l
 			(*bin)[i / 2] |= ch << 4;
 		} else {
 			/* LSB */
-			(*bin)[i / 2] = 0;
-			(*bin)[i / 2] |= ch;
+			(*bin)[i / 2] = ch;
 		}
 	}
 
@@ -953,9 +1458,15 @@ static int svf_check_tdo(void)
 
 static int svf_add_check_para(uint8_t enabled, int buffer_offset, int bit_len)
 {
-	if (svf_check_tdo_para_index >= SVF_CHECK_TDO_PARA_SIZE) {
-		LOG_ERROR("toooooo many operation undone");
-		return ERROR_FAIL;
+	if (svf_check_tdo_para_index >= svf_check_tdo_para_size) {
+		struct svf_check_tdo_para *tmp = realloc(svf_check_tdo_para,
+			sizeof(struct svf_check_tdo_para) * svf_check_tdo_para_size * 2);
+		if (!tmp) {
+			LOG_ERROR("not enough memory");
+			return ERROR_FAIL;
+		}
+		svf_check_tdo_para = tmp;
+		svf_check_tdo_para_size *= 2;
 	}
 
 	svf_check_tdo_para[svf_check_tdo_para_index].line_num = svf_line_number;
@@ -969,6 +1480,8 @@ static int svf_add_check_para(uint8_t enabled, int buffer_offset, int bit_len)
 
 static int svf_execute_tap(void)
 {
+	svf_cache_write_u8(SVF_CACHE_OP_EXECUTE);
+
 	if ((!svf_nil) && (jtag_execute_queue() != ERROR_OK))
 		return ERROR_FAIL;
 	else if (svf_check_tdo() != ERROR_OK)
@@ -1052,6 +1565,8 @@ static int svf_run_command(struct command_context *cmd_ctx, char *cmd_str)
 				svf_para.frequency = atof(argus[1]);
 				/* TODO: set jtag speed to */
 				if (svf_para.frequency > 0) {
+					svf_cache_write_u8(SVF_CACHE_OP_FREQUENCY);
+					svf_cache_write_u32((int)svf_para.frequency / 1000);
 					command_run_linef(cmd_ctx,
 							"adapter speed %d",
 							(int)svf_para.frequency / 1000);
@@ -1268,6 +1783,8 @@ xxr_common:
 				field.num_bits = i;
 				field.out_value = &svf_tdi_buffer[svf_buffer_index];
 				field.in_value = (xxr_para_tmp->data_mask & XXR_TDO) ? &svf_tdi_buffer[svf_buffer_index] : NULL;
+				svf_cache_record_scan(SVF_CACHE_OP_DR_SCAN, field.num_bits,
+						field.in_value != NULL, svf_para.dr_end_state);
 				if (!svf_nil) {
 					/* NOTE:  doesn't use SVF-specified state paths */
 					jtag_add_plain_dr_scan(field.num_bits,
@@ -1277,7 +1794,7 @@ xxr_common:
 				}
 
 				if (svf_addcycles)
-					jtag_add_clocks(svf_addcycles);
+					svf_queue_clocks(svf_addcycles);
 
 				svf_buffer_index += (i + 7) >> 3;
 			} else if (command == SIR) {
@@ -1361,6 +1878,8 @@ xxr_common:
 				field.num_bits = i;
 				field.out_value = &svf_tdi_buffer[svf_buffer_index];
 				field.in_value = (xxr_para_tmp->data_mask & XXR_TDO) ? &svf_tdi_buffer[svf_buffer_index] : NULL;
+				svf_cache_record_scan(SVF_CACHE_OP_IR_SCAN, field.num_bits,
+						field.in_value != NULL, svf_para.ir_end_state);
 				if (!svf_nil) {
 					/* NOTE:  doesn't use SVF-specified state paths */
 					jtag_add_plain_ir_scan(field.num_bits,
@@ -1459,15 +1978,11 @@ xxr_common:
 					svf_add_statemove(svf_para.runtest_run_state);
 
 				/* add clocks and/or min wait */
-				if (run_count > 0) {
-					if (!svf_nil)
-						jtag_add_clocks(run_count);
-				}
+				if (run_count > 0)
+					svf_queue_clocks(run_count);
 
-				if (min_usec > 0) {
-					if (!svf_nil)
-						jtag_add_sleep(min_usec);
-				}
+				if (min_usec > 0)
+					svf_queue_sleep(min_usec);
 
 				/* move to end_state if necessary */
 				if (svf_para.runtest_end_state != svf_para.runtest_run_state)
@@ -1515,12 +2030,9 @@ xxr_common:
 					/* OpenOCD refuses paths containing TAP_RESET */
 					if (path[i] == TAP_RESET) {
 						/* FIXME last state MUST be stable! */
-						if (i > 0) {
-							if (!svf_nil)
-								jtag_add_pathmove(i, path);
-						}
-						if (!svf_nil)
-							jtag_add_tlr();
+						if (i > 0)
+							svf_queue_pathmove(i, path);
+						svf_queue_tlr();
 						num_of_argu -= i + 1;
 						i = -1;
 					}
@@ -1529,8 +2041,7 @@ xxr_common:
 					/* execute last path if necessary */
 					if (svf_tap_state_is_stable(path[num_of_argu - 1])) {
 						/* last state MUST be stable state */
-						if (!svf_nil)
-							jtag_add_pathmove(num_of_argu, path);
+						svf_queue_pathmove(num_of_argu, path);
 						LOG_DEBUG("\tmove to %s by path_move",
 								tap_state_name(path[num_of_argu - 1]));
 					} else {
@@ -1573,13 +2084,11 @@ xxr_common:
 						ARRAY_SIZE(svf_trst_mode_name));
 				switch (i_tmp) {
 				case TRST_ON:
-					if (!svf_nil)
-						jtag_add_reset(1, 0);
+					svf_queue_reset(1);
 					break;
 				case TRST_Z:
 				case TRST_OFF:
-					if (!svf_nil)
-						jtag_add_reset(0, 0);
+					svf_queue_reset(0);
 					break;
 				case TRST_ABSENT:
 					break;
@@ -1620,7 +2129,7 @@ xxr_common:
 		/* for fast executing, execute tap if necessary */
 		/* half of the buffer is for the next command */
 		if (((svf_buffer_index >= SVF_MAX_BUFFER_SIZE_TO_COMMIT) ||
-				(svf_check_tdo_para_index >= SVF_CHECK_TDO_PARA_SIZE / 2)) &&
+				(svf_check_tdo_para_index >= SVF_MAX_SCANS_TO_COMMIT)) &&
 				(((command != STATE) && (command != RUNTEST)) ||
 						((command == STATE) && (num_of_argu == 2))))
 			return svf_execute_tap();
@@ -1635,7 +2144,7 @@ static const struct command_registration svf_command_handlers[] = {
 		.handler = handle_svf_command,
 		.mode = COMMAND_EXEC,
 		.help = "Runs a SVF file.",
-		.usage = "[-tap device.tap] [-quiet] [-nil] [-progress] [-ignore_error] [-noreset] [-addcycles numcycles] file",
+		.usage = "[-tap device.tap] [-quiet] [-nil] [-progress] [-ignore_error] [-noreset] [-addcycles numcycles] [-cache] file",
 	},
 	COMMAND_REGISTRATION_DONE
 };
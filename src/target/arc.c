@@ -283,9 +283,109 @@ static int arc_set_register(struct reg *reg, uint8_t *buf)
 	return ERROR_OK;
 }
 
+/**
+ * Read all invalid ARC registers of @a reg_list with one JTAG queue execution,
+ * instead of one per register as arc_get_register() would do. Used for GDB
+ * 'g' packets, which also contain registers arc_save_context() doesn't read.
+ * All registers are expected to belong to the same target.
+ */
+static int arc_get_registers(struct reg **reg_list, unsigned int count)
+{
+	struct target *target = NULL;
+	unsigned int core_cnt = 0;
+	unsigned int aux_cnt = 0;
+	unsigned int i;
+	int retval = ERROR_OK;
+
+	for (i = 0; i < count; i++) {
+		struct reg *reg = reg_list[i];
+		if (!reg || reg->type->get != arc_get_register || !reg->exist || reg->hidden || reg->valid)
+			continue;
+
+		struct arc_reg_desc *desc = reg->arch_info;
+		if (!target)
+			target = desc->target;
+		/* Batch only lists of one target, leave others to the per-register
+		 * fallback of register_get_multiple() */
+		if (desc->target != target)
+			return ERROR_FAIL;
+
+		/* Accessing to R61/R62 registers causes Jtag hang */
+		if (desc->is_core && (desc->arch_num == ARC_R61 || desc->arch_num == ARC_R62))
+			return ERROR_FAIL;
+
+		if (desc->is_core)
+			core_cnt++;
+		else
+			aux_cnt++;
+	}
+
+	if (!core_cnt && !aux_cnt)
+		return ERROR_OK;
+
+	struct arc_common *arc = target_to_arc(target);
+	uint32_t *core_addrs = calloc(core_cnt + 1, sizeof(uint32_t));
+	uint32_t *core_values = calloc(core_cnt + 1, sizeof(uint32_t));
+	uint32_t *aux_addrs = calloc(aux_cnt + 1, sizeof(uint32_t));
+	uint32_t *aux_values = calloc(aux_cnt + 1, sizeof(uint32_t));
+
+	if (!core_addrs || !core_values || !aux_addrs || !aux_values) {
+		LOG_ERROR("Unable to allocate memory");
+		retval = ERROR_FAIL;
+		goto exit;
+	}
+
+	core_cnt = 0;
+	aux_cnt = 0;
+	for (i = 0; i < count; i++) {
+		struct reg *reg = reg_list[i];
+		if (!reg || reg->type->get != arc_get_register || !reg->exist || reg->hidden || reg->valid)
+			continue;
+
+		struct arc_reg_desc *desc = reg->arch_info;
+		if (desc->is_core)
+			core_addrs[core_cnt++] = desc->arch_num;
+		else
+			aux_addrs[aux_cnt++] = desc->arch_num;
+	}
+
+	retval = arc_jtag_read_core_and_aux_reg(&arc->jtag_info, core_addrs, core_cnt,
+			core_values, aux_addrs, aux_cnt, aux_values);
+	if (retval != ERROR_OK)
+		goto exit;
+
+	core_cnt = 0;
+	aux_cnt = 0;
+	for (i = 0; i < count; i++) {
+		struct reg *reg = reg_list[i];
+		if (!reg || reg->type->get != arc_get_register || !reg->exist || reg->hidden || reg->valid)
+			continue;
+
+		struct arc_reg_desc *desc = reg->arch_info;
+		uint32_t value = desc->is_core ? core_values[core_cnt++] : aux_values[aux_cnt++];
+		target_buffer_set_u32(target, reg->value, value);
+
+		/* If target is unhalted all register reads should be uncached. */
+		reg->valid = target->state == TARGET_HALTED;
+		reg->dirty = false;
+
+		LOG_DEBUG("Get register gdb_num=%" PRIu32 ", name=%s, value=0x%" PRIx32,
+				reg->number, desc->name, value);
+	}
+
+exit:
+	free(core_addrs);
+	free(core_values);
+	free(aux_addrs);
+	free(aux_values);
+
+	return retval;
+}
+
 static const struct reg_arch_type arc_reg_type = {
 	.get = arc_get_register,
 	.set = arc_set_register,
+	.get_multiple = arc_get_registers,
 };
 
 /* GDB register groups. For now we support only general and "empty" */
@@ -864,21 +964,12 @@ static int arc_save_context(struct target *target)
 	}
 
 	/* Read data from target. */
-	if (core_cnt > 0) {
-		retval = arc_jtag_read_core_reg(&arc->jtag_info, core_addrs, core_cnt, core_values);
-		if (retval != ERROR_OK) {
-			LOG_ERROR("Attempt to read core registers failed.");
-			retval = ERROR_FAIL;
-			goto exit;
-		}
-	}
-	if (aux_cnt > 0) {
-		retval = arc_jtag_read_aux_reg(&arc->jtag_info, aux_addrs, aux_cnt, aux_values);
-		if (retval != ERROR_OK) {
-			LOG_ERROR("Attempt to read aux registers failed.");
-			retval = ERROR_FAIL;
-			goto exit;
-		}
+	retval = arc_jtag_read_core_and_aux_reg(&arc->jtag_info, core_addrs, core_cnt,
+			core_values, aux_addrs, aux_cnt, aux_values);
+	if (retval != ERROR_OK) {
+		LOG_ERROR("Attempt to read core and aux registers failed.");
+		retval = ERROR_FAIL;
+		goto exit;
 	}
 
 	/* Parse core regs */
@@ -1009,13 +1100,10 @@ static int arc_debug_entry(struct target *target)
 	return ERROR_OK;
 }
 
-static int arc_poll(struct target *target)
+/* Update the target state from the JTAG STATUS register */
+static int arc_poll_status(struct target *target, uint32_t status)
 {
-	uint32_t status, value;
-	struct arc_common *arc = target_to_arc(target);
-
-	/* gdb calls continuously through this arc_poll() function  */
-	CHECK_RETVAL(arc_jtag_status(&arc->jtag_info, &status));
+	uint32_t value;
 
 	/* check for processor halted */
 	if (status & ARC_JTAG_STAT_RU) {
@@ -1055,6 +1143,35 @@ static int arc_poll(struct target *target)
 	return ERROR_OK;
 }
 
+static int arc_poll(struct target *target)
+{
+	uint32_t status;
+	struct arc_common *arc = target_to_arc(target);
+
+	/* gdb calls continuously through this arc_poll() function  */
+	CHECK_RETVAL(arc_jtag_status(&arc->jtag_info, &status));
+
+	return arc_poll_status(target, status);
+}
+
+static int arc_poll_queue(struct target *target)
+{
+	struct arc_common *arc = target_to_arc(target);
+
+	arc_jtag_enque_status(&arc->jtag_info, arc->poll_status);
+
+	return ERROR_OK;
+}
+
+static int arc_poll_complete(struct target *target, int queue_retval)
+{
+	struct arc_common *arc = target_to_arc(target);
+
+	CHECK_RETVAL(queue_retval);
+
+	return arc_poll_status(target, buf_get_u32(arc->poll_status, 0, 32));
+}
+
 static int arc_assert_reset(struct target *target)
 {
 	struct arc_common *arc = target_to_arc(target);
@@ -2241,6 +2358,8 @@ struct target_type arcv2_target = {
 	.name = "arcv2",
 
 	.poll =	arc_poll,
+	.poll_queue = arc_poll_queue,
+	.poll_complete = arc_poll_complete,
 
 	.arch_state = arc_arch_state,
 
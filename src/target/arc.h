@@ -186,6 +186,8 @@ struct arc_common {
 	unsigned int common_magic;
 
 	struct arc_jtag jtag_info;
+	/* JTAG STATUS register read by arc_poll_queue() */
+	uint8_t poll_status[sizeof(uint32_t)];
 
 	struct reg_cache *core_and_aux_cache;
 	struct reg_cache *bcr_cache;
@@ -175,18 +175,27 @@ int arc_jtag_startup(struct arc_jtag *jtag_info)
 	return jtag_execute_queue();
 }
 
-/** Read STATUS register. */
-int arc_jtag_status(struct arc_jtag * const jtag_info, uint32_t * const value)
+/**
+ * Queue a read of the STATUS register into @a buffer, without executing the
+ * queue. The 4-byte buffer is valid after jtag_execute_queue().
+ */
+void arc_jtag_enque_status(struct arc_jtag * const jtag_info, uint8_t * const buffer)
 {
-	uint8_t buffer[sizeof(uint32_t)];
-
 	assert(jtag_info);
 	assert(jtag_info->tap);
 
-	/* Fill command queue. */
 	arc_jtag_enque_reset_transaction(jtag_info);
 	arc_jtag_enque_status_read(jtag_info, buffer);
 	arc_jtag_enque_reset_transaction(jtag_info);
+}
+
+/** Read STATUS register. */
+int arc_jtag_status(struct arc_jtag * const jtag_info, uint32_t * const value)
+{
+	uint8_t buffer[sizeof(uint32_t)];
+
+	/* Fill command queue. */
+	arc_jtag_enque_status(jtag_info, buffer);
 
 	/* Execute queue. */
 	CHECK_RETVAL(jtag_execute_queue());
@@ -263,6 +272,20 @@ static int arc_jtag_write_registers(struct arc_jtag *jtag_info, uint32_t type,
 	return jtag_execute_queue();
 }
 
+/* Queue reading of registers of one type into 4-byte buffers in data_buf. */
+static void arc_jtag_enque_read_registers(struct arc_jtag *jtag_info, uint32_t type,
+		uint32_t *addr, uint32_t count, uint8_t *data_buf)
+{
+	arc_jtag_enque_reset_transaction(jtag_info);
+
+	/* What type of registers we are reading? */
+	const uint32_t transaction = (type == ARC_JTAG_CORE_REG ?
+			ARC_JTAG_READ_FROM_CORE_REG : ARC_JTAG_READ_FROM_AUX_REG);
+	arc_jtag_enque_set_transaction(jtag_info, transaction, TAP_DRPAUSE);
+
+	arc_jtag_enque_register_rw(jtag_info, addr, data_buf, NULL, count);
+}
+
 /**
  * Read registers. addr is an array of addresses, and those addresses can be in
  * any order, though it is recommended that they are in sequential order where
@@ -291,16 +314,9 @@ static int arc_jtag_read_registers(struct arc_jtag *jtag_info, uint32_t type,
 		return ERROR_FAIL;
 	}
 
-	arc_jtag_enque_reset_transaction(jtag_info);
-
-	/* What type of registers we are reading? */
-	const uint32_t transaction = (type == ARC_JTAG_CORE_REG ?
-			ARC_JTAG_READ_FROM_CORE_REG : ARC_JTAG_READ_FROM_AUX_REG);
-	arc_jtag_enque_set_transaction(jtag_info, transaction, TAP_DRPAUSE);
-
 	uint8_t *data_buf = calloc(sizeof(uint8_t), count * 4);
 
-	arc_jtag_enque_register_rw(jtag_info, addr, data_buf, NULL, count);
+	arc_jtag_enque_read_registers(jtag_info, type, addr, count, data_buf);
 
 	retval = jtag_execute_queue();
 	if (retval != ERROR_OK) {
@@ -418,6 +434,60 @@ int arc_jtag_read_aux_reg(struct arc_jtag *jtag_info, uint32_t *addr,
 			buffer);
 }
 
+/**
+ * Read core and AUX registers with a single execution of the JTAG queue.
+ * Either count may be zero.
+ *
+ * @param jtag_info
+ * @param core_addr	Array of core register numbers.
+ * @param core_count	Amount of core registers.
+ * @param core_buffer	Array of core register values.
+ * @param aux_addr	Array of AUX register numbers.
+ * @param aux_count	Amount of AUX registers.
+ * @param aux_buffer	Array of AUX register values.
+ */
+int arc_jtag_read_core_and_aux_reg(struct arc_jtag *jtag_info,
+		uint32_t *core_addr, uint32_t core_count, uint32_t *core_buffer,
+		uint32_t *aux_addr, uint32_t aux_count, uint32_t *aux_buffer)
+{
+	uint32_t i;
+
+	assert(jtag_info);
+	assert(jtag_info->tap);
+
+	if (!core_count && !aux_count)
+		return ERROR_OK;
+
+	uint8_t *data_buf = calloc(sizeof(uint8_t), (core_count + aux_count) * 4);
+	if (!data_buf) {
+		LOG_ERROR("Unable to allocate memory");
+		return ERROR_FAIL;
+	}
+
+	if (core_count)
+		arc_jtag_enque_read_registers(jtag_info, ARC_JTAG_CORE_REG, core_addr,
+			core_count, data_buf);
+	if (aux_count)
+		arc_jtag_enque_read_registers(jtag_info, ARC_JTAG_AUX_REG, aux_addr,
+			aux_count, data_buf + core_count * 4);
+
+	int retval = jtag_execute_queue();
+	if (retval != ERROR_OK) {
+		LOG_ERROR("Failed to execute jtag queue: %d", retval);
+		free(data_buf);
+		return ERROR_FAIL;
+	}
+
+	for (i = 0; i < core_count; i++)
+		core_buffer[i] = buf_get_u32(data_buf + 4 * i, 0, 32);
+	for (i = 0; i < aux_count; i++)
+		aux_buffer[i] = buf_get_u32(data_buf + 4 * (core_count + i), 0, 32);
+
+	free(data_buf);
+
+	return ERROR_OK;
+}
+
 /**
  * Write a sequence of 4-byte words into target memory.
  *
@@ -44,6 +44,7 @@ struct arc_jtag {
 
 int arc_jtag_startup(struct arc_jtag *jtag_info);
 int arc_jtag_status(struct arc_jtag *const jtag_info, uint32_t *const value);
+void arc_jtag_enque_status(struct arc_jtag *const jtag_info, uint8_t *const buffer);
 
 int arc_jtag_write_core_reg(struct arc_jtag *jtag_info, uint32_t *addr,
 	uint32_t count, const uint32_t *buffer);
@@ -60,6 +61,9 @@ int arc_jtag_write_aux_reg_one(struct arc_jtag *jtag_info, uint32_t addr,
 	uint32_t value);
 int arc_jtag_read_aux_reg(struct arc_jtag *jtag_info, uint32_t *addr,
 	uint32_t count, uint32_t *buffer);
+int arc_jtag_read_core_and_aux_reg(struct arc_jtag *jtag_info,
+	uint32_t *core_addr, uint32_t core_count, uint32_t *core_buffer,
+	uint32_t *aux_addr, uint32_t aux_count, uint32_t *aux_buffer);
 int arc_jtag_read_aux_reg_one(struct arc_jtag *jtag_info, uint32_t addr,
 	uint32_t *value);
 
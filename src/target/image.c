@@ -24,6 +24,7 @@
 #include "image.h"
 #include "target.h"
 #include <helper/log.h>
+#include <helper/crc32.h>
 
 /* convert ELF header field to host endianness */
 #define field16(elf, field) \
@@ -642,6 +643,34 @@ static int image_elf_read_headers(struct image *image)
 	}
 }
 
+static int image_elf_read_file(struct image_elf *elf, uint64_t position,
+	size_t size, uint8_t *buffer)
+{
+	size_t really_read;
+	int retval;
+
+	if (elf->map && position <= elf->map_size && size <= elf->map_size - position) {
+		retval = fileio_map_check(elf->fileio);
+		if (retval != ERROR_OK)
+			return retval;
+		memcpy(buffer, elf->map + position, size);
+		return ERROR_OK;
+	}
+
+	retval = fileio_seek(elf->fileio, position);
+	if (retval != ERROR_OK) {
+		LOG_ERROR("cannot find ELF segment content, seek failed");
+		return retval;
+	}
+	retval = fileio_read(elf->fileio, size, buffer, &really_read);
+	if (retval != ERROR_OK) {
+		LOG_ERROR("cannot read ELF segment content, read failed");
+		return retval;
+	}
+
+	return ERROR_OK;
+}
+
 static int image_elf32_read_section(struct image *image,
 	int section,
 	target_addr_t offset,
@@ -651,7 +680,7 @@ static int image_elf32_read_section(struct image *image,
 {
 	struct image_elf *elf = image->type_private;
 	Elf32_Phdr *segment = (Elf32_Phdr *)image->sections[section].private;
-	size_t read_size, really_read;
+	size_t read_size;
 	int retval;
 
 	*size_read = 0;
@@ -665,16 +694,10 @@ static int image_elf32_read_section(struct image *image,
 		LOG_DEBUG("read elf: size = 0x%zx at 0x%" TARGET_PRIxADDR "", read_size,
 			field32(elf, segment->p_offset) + offset);
 		/* read initialized area of the segment */
-		retval = fileio_seek(elf->fileio, field32(elf, segment->p_offset) + offset);
-		if (retval != ERROR_OK) {
-			LOG_ERROR("cannot find ELF segment content, seek failed");
-			return retval;
-		}
-		retval = fileio_read(elf->fileio, read_size, buffer, &really_read);
-		if (retval != ERROR_OK) {
-			LOG_ERROR("cannot read ELF segment content, read failed");
+		retval = image_elf_read_file(elf, field32(elf, segment->p_offset) + offset,
+				read_size, buffer);
+		if (retval != ERROR_OK)
 			return retval;
-		}
 		size -= read_size;
 		*size_read += read_size;
 		/* need more data ? */
@@ -694,7 +717,7 @@ static int image_elf64_read_section(struct image *image,
 {
 	struct image_elf *elf = image->type_private;
 	Elf64_Phdr *segment = (Elf64_Phdr *)image->sections[section].private;
-	size_t read_size, really_read;
+	size_t read_size;
 	int retval;
 
 	*size_read = 0;
@@ -708,16 +731,10 @@ static int image_elf64_read_section(struct image *image,
 		LOG_DEBUG("read elf: size = 0x%zx at 0x%" TARGET_PRIxADDR "", read_size,
 			field64(elf, segment->p_offset) + offset);
 		/* read initialized area of the segment */
-		retval = fileio_seek(elf->fileio, field64(elf, segment->p_offset) + offset);
-		if (retval != ERROR_OK) {
-			LOG_ERROR("cannot find ELF segment content, seek failed");
-			return retval;
-		}
-		retval = fileio_read(elf->fileio, read_size, buffer, &really_read);
-		if (retval != ERROR_OK) {
-			LOG_ERROR("cannot read ELF segment content, read failed");
+		retval = image_elf_read_file(elf, field64(elf, segment->p_offset) + offset,
+				read_size, buffer);
+		if (retval != ERROR_OK)
 			return retval;
-		}
 		size -= read_size;
 		*size_read += read_size;
 		/* need more data ? */
@@ -743,6 +760,41 @@ static int image_elf_read_section(struct image *image,
 		return image_elf32_read_section(image, section, offset, size, buffer, size_read);
 }
 
+static int image_elf_section_view(struct image *image,
+	int section,
+	target_addr_t offset,
+	uint32_t size,
+	const uint8_t **view)
+{
+	struct image_elf *elf = image->type_private;
+	uint64_t file_offset, file_size;
+
+	if (!elf->map)
+		return ERROR_NOT_IMPLEMENTED;
+
+	if (elf->is_64_bit) {
+		Elf64_Phdr *segment = (Elf64_Phdr *)image->sections[section].private;
+		file_offset = field64(elf, segment->p_offset);
+		file_size = field64(elf, segment->p_filesz);
+	} else {
+		Elf32_Phdr *segment = (Elf32_Phdr *)image->sections[section].private;
+		file_offset = field32(elf, segment->p_offset);
+		file_size = field32(elf, segment->p_filesz);
+	}
+
+	/* the zero initialized part of a segment is not in the file */
+	if (offset + size > file_size || file_offset > elf->map_size ||
+			offset + size > elf->map_size - file_offset)
+		return ERROR_NOT_IMPLEMENTED;
+
+	int retval = fileio_map_check(elf->fileio);
+	if (retval != ERROR_OK)
+		return retval;
+
+	*view = elf->map + file_offset + offset;
+	return ERROR_OK;
+}
+
 static int image_mot_buffer_complete_inner(struct image *image,
 	char *lpsz_line,
 	struct imagesection *section)
@@ -974,6 +1026,12 @@ int image_open(struct image *image, const char *url, const char *type_string)
 		image->sections[0].base_address = 0x0;
 		image->sections[0].size = filesize;
 		image->sections[0].flags = 0;
+
+		/* optional, fileio_read() is used otherwise */
+		const void *map;
+		image_binary->map = NULL;
+		if (fileio_map(image_binary->fileio, &map) == ERROR_OK)
+			image_binary->map = map;
 	} else if (image->type == IMAGE_IHEX) {
 		struct image_ihex *image_ihex;
 
@@ -999,6 +1057,14 @@ int image_open(struct image *image, const char *url, const char *type_string)
 		if (retval != ERROR_OK)
 			return retval;
 
+		/* optional, fileio_read() is used otherwise */
+		const void *map;
+		image_elf->map = NULL;
+		image_elf->map_size = 0;
+		if (fileio_map(image_elf->fileio, &map) == ERROR_OK &&
+				fileio_size(image_elf->fileio, &image_elf->map_size) == ERROR_OK)
+			image_elf->map = map;
+
 		retval = image_elf_read_headers(image);
 		if (retval != ERROR_OK) {
 			fileio_close(image_elf->fileio);
@@ -1088,6 +1154,15 @@ int image_read_section(struct image *image,
 		if (section != 0)
 			return ERROR_COMMAND_SYNTAX_ERROR;
 
+		if (image_binary->map) {
+			retval = fileio_map_check(image_binary->fileio);
+			if (retval != ERROR_OK)
+				return retval;
+			memcpy(buffer, image_binary->map + offset, size);
+			*size_read = size;
+			return ERROR_OK;
+		}
+
 		/* seek to offset */
 		retval = fileio_seek(image_binary->fileio, offset);
 		if (retval != ERROR_OK)
@@ -1157,6 +1232,44 @@ int image_read_section(struct image *image,
 	return ERROR_OK;
 }
 
+/**
+ * Get the contents of part of a section without copying them, e.g. from
+ * a memory mapped file. The view stays valid until the image is closed.
+ * It may be mapped read-only, so it must not be handed to code which
+ * writes through its buffer, such as some flash drivers do.
+ * @returns ERROR_NOT_IMPLEMENTED if the image type or section can't provide
+ * one, the caller has to use image_read_section() instead.
+ */
+int image_section_view(struct image *image, int section, target_addr_t offset,
+		uint32_t size, const uint8_t **view)
+{
+	/* don't read past the end of a section */
+	if (offset + size > image->sections[section].size)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (image->type == IMAGE_BINARY) {
+		struct image_binary *image_binary = image->type_private;
+
+		if (!image_binary->map)
+			return ERROR_NOT_IMPLEMENTED;
+
+		int retval = fileio_map_check(image_binary->fileio);
+		if (retval != ERROR_OK)
+			return retval;
+
+		*view = image_binary->map + offset;
+	} else if (image->type == IMAGE_ELF) {
+		return image_elf_section_view(image, section, offset, size, view);
+	} else if (image->type == IMAGE_IHEX || image->type == IMAGE_SRECORD ||
+			image->type == IMAGE_BUILDER) {
+		*view = (uint8_t *)image->sections[section].private + offset;
+	} else {
+		return ERROR_NOT_IMPLEMENTED;
+	}
+
+	return ERROR_OK;
+}
+
 int image_add_section(struct image *image, target_addr_t base, uint32_t size, uint64_t flags, uint8_t const *data)
 {
 	struct imagesection *section;
@@ -1256,31 +1369,12 @@ int image_calculate_checksum(const uint8_t *buffer, uint32_t nbytes, uint32_t *c
 	uint32_t crc = 0xffffffff;
 	LOG_DEBUG("Calculating checksum");
 
-	static uint32_t crc32_table[256];
-
-	static bool first_init;
-	if (!first_init) {
-		/* Initialize the CRC table and the decoding table.  */
-		unsigned int i, j, c;
-		for (i = 0; i < 256; i++) {
-			/* as per gdb */
-			for (c = i << 24, j = 8; j > 0; --j)
-				c = c & 0x80000000 ? (c << 1) ^ 0x04c11db7 : (c << 1);
-			crc32_table[i] = c;
-		}
-
-		first_init = true;
-	}
-
 	while (nbytes > 0) {
-		int run = nbytes;
-		if (run > 32768)
-			run = 32768;
+		uint32_t run = MIN(nbytes, 1024 * 1024);
+		/* as per gdb */
+		crc = crc32_be(CRC32_POLY_BE, crc, buffer, run);
+		buffer += run;
 		nbytes -= run;
-		while (run--) {
-			/* as per gdb */
-			crc = (crc << 8) ^ crc32_table[((crc >> 24) ^ *buffer++) & 255];
-		}
 		keep_alive();
 	}
 
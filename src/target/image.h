@@ -58,6 +58,7 @@ struct image {
 
 struct image_binary {
 	struct fileio *fileio;
+	const uint8_t *map;		/* file contents if mapped, else NULL */
 };
 
 struct image_ihex {
@@ -73,6 +74,8 @@ struct image_memory {
 
 struct image_elf {
 	struct fileio *fileio;
+	const uint8_t *map;		/* file contents if mapped, else NULL */
+	size_t map_size;
 	bool is_64_bit;
 	union {
 		Elf32_Ehdr *header32;
@@ -94,6 +97,8 @@ struct image_mot {
 int image_open(struct image *image, const char *url, const char *type_string);
 int image_read_section(struct image *image, int section, target_addr_t offset,
 		uint32_t size, uint8_t *buffer, size_t *size_read);
+int image_section_view(struct image *image, int section, target_addr_t offset,
+		uint32_t size, const uint8_t **view);
 void image_close(struct image *image);
 
 int image_add_section(struct image *image, target_addr_t base, uint32_t size,
@@ -0,0 +1,396 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <helper/log.h>
+
+#include "memory_cache.h"
+#include "target.h"
+#include "target_type.h"
+
+#define MEMORY_CACHE_PAGE_SIZE		1024
+#define MEMORY_CACHE_BUCKETS		256
+/* The cache is emptied when it grows beyond this many pages */
+#define MEMORY_CACHE_MAX_PAGES		1024
+
+struct memory_cache_region {
+	target_addr_t address;
+	target_addr_t last;		/* inclusive, so a region can end at the top of memory */
+};
+
+struct memory_cache_page {
+	target_addr_t address;
+	/* Index of the region the page was read from. Only the part of the page
+	 * inside that region holds valid data. */
+	unsigned int region;
+	struct memory_cache_page *next;
+	uint8_t data[MEMORY_CACHE_PAGE_SIZE];
+};
+
+struct target_memory_cache {
+	bool enabled;
+	struct memory_cache_region *regions;
+	unsigned int num_regions;
+	struct memory_cache_page *buckets[MEMORY_CACHE_BUCKETS];
+	unsigned int num_pages;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t invalidations;
+};
+
+static struct target_memory_cache *memory_cache_get(struct target *target, bool create)
+{
+	if (!target->memory_cache && create)
+		target->memory_cache = calloc(1, sizeof(struct target_memory_cache));
+	return target->memory_cache;
+}
+
+static unsigned int memory_cache_bucket(target_addr_t page_address)
+{
+	return (page_address / MEMORY_CACHE_PAGE_SIZE) % MEMORY_CACHE_BUCKETS;
+}
+
+/* Returns the index of the region holding all of the range, or -1 */
+static int memory_cache_find_region(const struct target_memory_cache *cache,
+		target_addr_t address, uint32_t size)
+{
+	target_addr_t last = address + size - 1;
+
+	for (unsigned int i = 0; i < cache->num_regions; i++) {
+		if (address >= cache->regions[i].address && last <= cache->regions[i].last)
+			return i;
+	}
+	return -1;
+}
+
+static void memory_cache_drop_pages(struct target_memory_cache *cache)
+{
+	if (!cache->num_pages)
+		return;
+
+	for (unsigned int i = 0; i < MEMORY_CACHE_BUCKETS; i++) {
+		struct memory_cache_page *page = cache->buckets[i];
+		while (page) {
+			struct memory_cache_page *next = page->next;
+			free(page);
+			page = next;
+		}
+		cache->buckets[i] = NULL;
+	}
+	cache->num_pages = 0;
+	cache->invalidations++;
+}
+
+static struct memory_cache_page *memory_cache_lookup(struct target_memory_cache *cache,
+		target_addr_t page_address, unsigned int region)
+{
+	struct memory_cache_page *page = cache->buckets[memory_cache_bucket(page_address)];
+
+	while (page && (page->address != page_address || page->region != region))
+		page = page->next;
+	return page;
+}
+
+static int memory_cache_fill(struct target *target, struct target_memory_cache *cache,
+		target_addr_t page_address, unsigned int region, struct memory_cache_page **result)
+{
+	const struct memory_cache_region *r = &cache->regions[region];
+
+	if (cache->num_pages >= MEMORY_CACHE_MAX_PAGES)
+		memory_cache_drop_pages(cache);
+
+	struct memory_cache_page *page = malloc(sizeof(*page));
+	if (!page) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+
+	/* only read what lies inside the region, the rest might not be memory */
+	target_addr_t first = MAX(page_address, r->address);
+	target_addr_t last = MIN(page_address + (MEMORY_CACHE_PAGE_SIZE - 1), r->last);
+	int retval = target->type->read_buffer(target, first, last - first + 1,
+			page->data + (first - page_address));
+	if (retval != ERROR_OK) {
+		free(page);
+		return retval;
+	}
+
+	unsigned int bucket = memory_cache_bucket(page_address);
+	page->address = page_address;
+	page->region = region;
+	page->next = cache->buckets[bucket];
+	cache->buckets[bucket] = page;
+	cache->num_pages++;
+
+	*result = page;
+	return ERROR_OK;
+}
+
+bool target_memory_cache_usable(struct target *target, target_addr_t address,
+		uint32_t size)
+{
+	struct target_memory_cache *cache = target->memory_cache;
+
+	/* a running target changes memory behind our back */
+	if (!cache || !cache->enabled || target->state != TARGET_HALTED)
+		return false;
+
+	return memory_cache_find_region(cache, address, size) >= 0;
+}
+
+int target_memory_cache_read(struct target *target, target_addr_t address,
+		uint32_t size, uint8_t *buffer)
+{
+	struct target_memory_cache *cache = target->memory_cache;
+	int region = memory_cache_find_region(cache, address, size);
+	assert(region >= 0);
+
+	while (size > 0) {
+		target_addr_t page_address = address & ~(target_addr_t)(MEMORY_CACHE_PAGE_SIZE - 1);
+		uint32_t offset = address - page_address;
+		uint32_t count = MIN(size, MEMORY_CACHE_PAGE_SIZE - offset);
+
+		struct memory_cache_page *page = memory_cache_lookup(cache, page_address, region);
+		if (page) {
+			cache->hits++;
+		} else {
+			int retval = memory_cache_fill(target, cache, page_address, region, &page);
+			if (retval != ERROR_OK)
+				return retval;
+			cache->misses++;
+		}
+
+		memcpy(buffer, page->data + offset, count);
+		address += count;
+		buffer += count;
+		size -= count;
+	}
+
+	return ERROR_OK;
+}
+
+/* Update (buffer != NULL) or drop the cached pages overlapping a write */
+static void memory_cache_write_pages(struct target_memory_cache *cache,
+		target_addr_t address, uint32_t size, const uint8_t *buffer)
+{
+	target_addr_t last = address + size - 1;
+	target_addr_t page_address = address & ~(target_addr_t)(MEMORY_CACHE_PAGE_SIZE - 1);
+
+	while (cache->num_pages) {
+		struct memory_cache_page **link = &cache->buckets[memory_cache_bucket(page_address)];
+		while (*link) {
+			struct memory_cache_page *page = *link;
+			if (page->address != page_address) {
+				link = &page->next;
+				continue;
+			}
+
+			if (buffer) {
+				target_addr_t first = MAX(address, page_address);
+				target_addr_t end = MIN(last, page_address + (MEMORY_CACHE_PAGE_SIZE - 1));
+				memcpy(page->data + (first - page_address), buffer + (first - address),
+						end - first + 1);
+				link = &page->next;
+			} else {
+				*link = page->next;
+				free(page);
+				cache->num_pages--;
+			}
+		}
+
+		if (last - page_address < MEMORY_CACHE_PAGE_SIZE)
+			break;
+		page_address += MEMORY_CACHE_PAGE_SIZE;
+	}
+}
+
+void target_memory_cache_written(struct target *target, target_addr_t address,
+		uint32_t size, const uint8_t *buffer)
+{
+	if (size == 0)
+		return;
+
+	/* Writes outside of the cached regions may have side effects on memory,
+	 * e.g. a flash controller erasing a sector. */
+	struct target_memory_cache *own = target->memory_cache;
+	if (!own || memory_cache_find_region(own, address, size) < 0) {
+		target_memory_cache_invalidate_all();
+		return;
+	}
+
+	/* Other targets may share this memory, e.g. the cores of a SMP group */
+	for (struct target *t = all_targets; t; t = t->next) {
+		if (t->memory_cache)
+			memory_cache_write_pages(t->memory_cache, address, size,
+					t == target ? buffer : NULL);
+	}
+}
+
+void target_memory_cache_invalidate(struct target *target)
+{
+	if (target->memory_cache)
+		memory_cache_drop_pages(target->memory_cache);
+}
+
+void target_memory_cache_invalidate_all(void)
+{
+	for (struct target *target = all_targets; target; target = target->next)
+		target_memory_cache_invalidate(target);
+}
+
+void target_memory_cache_free(struct target *target)
+{
+	struct target_memory_cache *cache = target->memory_cache;
+	if (!cache)
+		return;
+
+	memory_cache_drop_pages(cache);
+	free(cache->regions);
+	free(cache);
+	target->memory_cache = NULL;
+}
+
+COMMAND_HANDLER(handle_mem_cache_region_command)
+{
+	struct target *target = get_current_target(CMD_CTX);
+
+	if (CMD_ARGC != 2)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	target_addr_t address, size;
+	COMMAND_PARSE_ADDRESS(CMD_ARGV[0], address);
+	COMMAND_PARSE_ADDRESS(CMD_ARGV[1], size);
+	if (size == 0 || address + size - 1 < address) {
+		command_print(CMD, "invalid region");
+		return ERROR_COMMAND_ARGUMENT_INVALID;
+	}
+
+	struct target_memory_cache *cache = memory_cache_get(target, true);
+	if (!cache) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+
+	struct memory_cache_region *regions = realloc(cache->regions,
+			(cache->num_regions + 1) * sizeof(*regions));
+	if (!regions) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+	regions[cache->num_regions].address = address;
+	regions[cache->num_regions].last = address + size - 1;
+	cache->regions = regions;
+	cache->num_regions++;
+
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_mem_cache_enable_command)
+{
+	struct target *target = get_current_target(CMD_CTX);
+
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	struct target_memory_cache *cache = memory_cache_get(target, true);
+	if (!cache) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+
+	if (!cache->num_regions)
+		LOG_WARNING("%s: no memory cache regions configured", target_name(target));
+	cache->enabled = true;
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_mem_cache_disable_command)
+{
+	struct target *target = get_current_target(CMD_CTX);
+
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	struct target_memory_cache *cache = memory_cache_get(target, false);
+	if (cache) {
+		memory_cache_drop_pages(cache);
+		cache->enabled = false;
+	}
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_mem_cache_invalidate_command)
+{
+	struct target *target = get_current_target(CMD_CTX);
+
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	target_memory_cache_invalidate(target);
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_mem_cache_stats_command)
+{
+	struct target *target = get_current_target(CMD_CTX);
+
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	struct target_memory_cache *cache = memory_cache_get(target, false);
+	if (!cache) {
+		command_print(CMD, "memory cache disabled, no regions");
+		return ERROR_OK;
+	}
+
+	command_print(CMD, "memory cache %s, %u pages of %u bytes cached",
+			cache->enabled ? "enabled" : "disabled", cache->num_pages,
+			MEMORY_CACHE_PAGE_SIZE);
+	for (unsigned int i = 0; i < cache->num_regions; i++)
+		command_print(CMD, "region " TARGET_ADDR_FMT " - " TARGET_ADDR_FMT,
+				cache->regions[i].address, cache->regions[i].last);
+	command_print(CMD, "page hits: %" PRIu64 ", misses: %" PRIu64 ", invalidations: %" PRIu64,
+			cache->hits, cache->misses, cache->invalidations);
+	return ERROR_OK;
+}
+
+const struct command_registration target_memory_cache_command_handlers[] = {
+	{
+		.name = "region",
+		.handler = handle_mem_cache_region_command,
+		.mode = COMMAND_ANY,
+		.help = "add a region of plain memory that may be cached",
+		.usage = "address size",
+	},
+	{
+		.name = "enable",
+		.handler = handle_mem_cache_enable_command,
+		.mode = COMMAND_ANY,
+		.help = "cache reads from the configured regions while halted",
+		.usage = "",
+	},
+	{
+		.name = "disable",
+		.handler = handle_mem_cache_disable_command,
+		.mode = COMMAND_ANY,
+		.help = "stop caching and drop the cached memory",
+		.usage = "",
+	},
+	{
+		.name = "invalidate",
+		.handler = handle_mem_cache_invalidate_command,
+		.mode = COMMAND_EXEC,
+		.help = "drop the cached memory",
+		.usage = "",
+	},
+	{
+		.name = "stats",
+		.handler = handle_mem_cache_stats_command,
+		.mode = COMMAND_EXEC,
+		.help = "show the configuration and hit/miss statistics",
+		.usage = "",
+	},
+	COMMAND_REGISTRATION_DONE
+};
@@ -0,0 +1,47 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef OPENOCD_TARGET_MEMORY_CACHE_H
+#define OPENOCD_TARGET_MEMORY_CACHE_H
+
+#include <helper/command.h>
+#include <helper/types.h>
+
+struct target;
+
+/**
+ * Host side cache of target memory, see the 'mem_cache' target command.
+ *
+ * Memory read by target_read_buffer() from the configured regions is kept
+ * in pages while the target is halted. Writes update the cached pages of the
+ * target they go to and drop the overlapping pages of all other targets.
+ * Anything that might change memory behind our back, like resuming,
+ * stepping, resetting or running an algorithm, drops the whole cache.
+ */
+
+extern const struct command_registration target_memory_cache_command_handlers[];
+
+/** Returns true if target_memory_cache_read() can serve this read. */
+bool target_memory_cache_usable(struct target *target, target_addr_t address,
+		uint32_t size);
+
+/** Read through the cache, filling missing pages from the target. */
+int target_memory_cache_read(struct target *target, target_addr_t address,
+		uint32_t size, uint8_t *buffer);
+
+/**
+ * Account for a write to target memory.
+ * @param buffer The data written, or NULL if the resulting memory contents
+ *               are unknown, e.g. after a failed write.
+ */
+void target_memory_cache_written(struct target *target, target_addr_t address,
+		uint32_t size, const uint8_t *buffer);
+
+/** Drop all cached pages of this target. */
+void target_memory_cache_invalidate(struct target *target);
+
+/** Drop all cached pages of all targets. */
+void target_memory_cache_invalidate_all(void);
+
+void target_memory_cache_free(struct target *target);
+
+#endif /* OPENOCD_TARGET_MEMORY_CACHE_H */
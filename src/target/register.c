@@ -103,6 +103,63 @@ void register_cache_invalidate(struct reg_cache *cache)
 	}
 }
 
+static bool register_type_in_list(const struct reg_arch_type **list, unsigned int count,
+		const struct reg_arch_type *type)
+{
+	for (unsigned int i = 0; i < count; i++)
+		if (list[i] == type)
+			return true;
+	return false;
+}
+
+/**
+ * Make the values of all existing, not hidden registers in @a reg_list valid.
+ * Register types providing get_multiple() read all their registers at once,
+ * the others are read one by one. NULL entries are skipped.
+ *
+ * All registers are tried even if some fail, the first error is returned.
+ */
+int register_get_multiple(struct reg **reg_list, unsigned int count)
+{
+	const struct reg_arch_type *batched[8];
+	unsigned int num_batched = 0;
+	int retval = ERROR_OK;
+
+	for (unsigned int i = 0; i < count; i++) {
+		struct reg *reg = reg_list[i];
+		if (!reg || !reg->exist || reg->hidden || reg->valid || !reg->type->get_multiple)
+			continue;
+
+		if (register_type_in_list(batched, num_batched, reg->type))
+			continue;
+
+		/* on failure the registers stay invalid and are read one by one */
+		if (reg->type->get_multiple(reg_list, count) != ERROR_OK)
+			LOG_DEBUG("Batched read failed, reading registers one by one");
+		else if (num_batched < ARRAY_SIZE(batched))
+			batched[num_batched++] = reg->type;
+	}
+
+	for (unsigned int i = 0; i < count; i++) {
+		struct reg *reg = reg_list[i];
+		if (!reg || !reg->exist || reg->hidden || reg->valid)
+			continue;
+
+		/* already read, but not cached, e.g. as the target is running */
+		if (register_type_in_list(batched, num_batched, reg->type))
+			continue;
+
+		int result = reg->type->get(reg);
+		if (result != ERROR_OK) {
+			LOG_DEBUG("Couldn't get register %s.", reg->name);
+			if (retval == ERROR_OK)
+				retval = result;
+		}
+	}
+
+	return retval;
+}
+
 static int register_get_dummy_core_reg(struct reg *reg)
 {
 	return ERROR_OK;
@@ -151,6 +151,10 @@ struct reg_cache {
 struct reg_arch_type {
 	int (*get)(struct reg *reg);
 	int (*set)(struct reg *reg, uint8_t *buf);
+	/* Optional. Read all registers of @a reg_list which use this type, exist,
+	 * are not hidden and not valid, in as few target accesses as possible.
+	 * Registers of other types in the list must be left untouched. */
+	int (*get_multiple)(struct reg **reg_list, unsigned int count);
 };
 
 struct reg *register_get_by_number(struct reg_cache *first,
@@ -160,6 +164,7 @@ struct reg *register_get_by_name(struct reg_cache *first,
 struct reg_cache **register_get_last_cache_p(struct reg_cache **first);
 void register_unlink_cache(struct reg_cache **cache_p, const struct reg_cache *cache);
 void register_cache_invalidate(struct reg_cache *cache);
+int register_get_multiple(struct reg **reg_list, unsigned int count);
 
 void register_init_dummy(struct reg *reg);
 
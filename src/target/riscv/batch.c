@@ -80,6 +80,19 @@ void riscv_batch_free(struct riscv_batch *batch)
 	free(batch);
 }
 
+void riscv_batch_reset(struct riscv_batch *batch, size_t idle)
+{
+	batch->used_scans = 0;
+	batch->read_keys_used = 0;
+	batch->idle_count = idle;
+	batch->last_scan = RISCV_SCAN_TYPE_INVALID;
+}
+
+size_t riscv_batch_capacity(struct riscv_batch *batch)
+{
+	return batch->allocated_scans - 4;
+}
+
 bool riscv_batch_full(struct riscv_batch *batch)
 {
 	return batch->used_scans > (batch->allocated_scans - 4);
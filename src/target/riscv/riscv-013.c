@@ -154,6 +154,23 @@ typedef struct {
 	struct target *target;
 } target_list_t;
 
+#define BATCH_MIN_SCANS		32
+#define BATCH_MAX_SCANS		1024
+
+/* State of the adaptive control of one busy delay. The delay grows by 10% on
+ * every busy response. After riscv_busy_delay_probe successful accesses a
+ * smaller delay is tried, and the step doubles as long as these probes
+ * succeed. */
+typedef struct {
+	/* Successful accesses since the last busy response or probe. */
+	unsigned int successes;
+	/* Next decrease of the delay. */
+	unsigned int step;
+	/* Statistics for `riscv info`. */
+	unsigned int busy_count;
+	unsigned int probe_count;
+} busy_delay_control_t;
+
 typedef struct {
 	/* The indexed used to address this hart in its DM. */
 	unsigned index;
@@ -191,6 +208,15 @@ typedef struct {
 	 * go low. */
 	unsigned int ac_busy_delay;
 
+	busy_delay_control_t dmi_busy_control;
+	busy_delay_control_t ac_busy_control;
+
+	/* Batch reused by the memory access functions, see get_batch(). */
+	struct riscv_batch *batch;
+	/* Number of scans per batch. Grows while batches complete without busy
+	 * responses, and shrinks when they don't. */
+	unsigned int batch_scans;
+
 	bool abstract_read_csr_supported;
 	bool abstract_write_csr_supported;
 	bool abstract_read_fpr_supported;
@@ -447,10 +473,47 @@ static uint32_t dtmcontrol_scan(struct target *target, uint32_t out)
 	return in;
 }
 
+static void busy_delay_increase(unsigned int *delay, busy_delay_control_t *control)
+{
+	*delay += *delay / 10 + 1;
+	*delay = MIN(MAX(*delay, riscv_busy_delay_min), riscv_busy_delay_max);
+
+	control->successes = 0;
+	control->step = 1;
+	control->busy_count++;
+}
+
+/* Returns true if the delay was decreased. */
+static bool busy_delay_succeeded(unsigned int *delay, busy_delay_control_t *control)
+{
+	if (!riscv_busy_delay_probe || *delay <= riscv_busy_delay_min)
+		return false;
+
+	if (++control->successes < riscv_busy_delay_probe)
+		return false;
+
+	control->successes = 0;
+	*delay -= MIN(MAX(control->step, 1), *delay - riscv_busy_delay_min);
+	if (control->step < riscv_busy_delay_max)
+		control->step *= 2;
+	control->probe_count++;
+	return true;
+}
+
+static void reset_busy_delays(riscv013_info_t *info)
+{
+	info->dmi_busy_delay = riscv_busy_delay_min;
+	info->ac_busy_delay = riscv_busy_delay_min;
+	info->dmi_busy_control.successes = 0;
+	info->dmi_busy_control.step = 1;
+	info->ac_busy_control.successes = 0;
+	info->ac_busy_control.step = 1;
+}
+
 static void increase_dmi_busy_delay(struct target *target)
 {
 	riscv013_info_t *info = get_info(target);
-	info->dmi_busy_delay += info->dmi_busy_delay / 10 + 1;
+	busy_delay_increase(&info->dmi_busy_delay, &info->dmi_busy_control);
 	LOG_DEBUG("dtmcs_idle=%d, dmi_busy_delay=%d, ac_busy_delay=%d",
 			info->dtmcs_idle, info->dmi_busy_delay,
 			info->ac_busy_delay);
@@ -481,10 +544,8 @@ static dmi_status_t dmi_scan(struct target *target, uint32_t *address_in,
 
 	if (r->reset_delays_wait >= 0) {
 		r->reset_delays_wait--;
-		if (r->reset_delays_wait < 0) {
-			info->dmi_busy_delay = 0;
-			info->ac_busy_delay = 0;
-		}
+		if (r->reset_delays_wait < 0)
+			reset_busy_delays(info);
 	}
 
 	memset(in, 0, num_bytes);
@@ -535,7 +596,14 @@ static dmi_status_t dmi_scan(struct target *target, uint32_t *address_in,
 	if (address_in)
 		*address_in = buf_get_u32(in, DTM_DMI_ADDRESS_OFFSET, info->abits);
 	dump_field(idle_count, &field);
-	return buf_get_u32(in, DTM_DMI_OP_OFFSET, DTM_DMI_OP_LENGTH);
+
+	dmi_status_t status = buf_get_u32(in, DTM_DMI_OP_OFFSET, DTM_DMI_OP_LENGTH);
+	if (status == DMI_STATUS_SUCCESS &&
+			busy_delay_succeeded(&info->dmi_busy_delay, &info->dmi_busy_control))
+		LOG_DEBUG("dtmcs_idle=%d, dmi_busy_delay=%d, ac_busy_delay=%d",
+				info->dtmcs_idle, info->dmi_busy_delay,
+				info->ac_busy_delay);
+	return status;
 }
 
 /**
@@ -711,12 +779,22 @@ static int dmstatus_read(struct target *target, uint32_t *dmstatus,
 static void increase_ac_busy_delay(struct target *target)
 {
 	riscv013_info_t *info = get_info(target);
-	info->ac_busy_delay += info->ac_busy_delay / 10 + 1;
+	busy_delay_increase(&info->ac_busy_delay, &info->ac_busy_control);
 	LOG_DEBUG("dtmcs_idle=%d, dmi_busy_delay=%d, ac_busy_delay=%d",
 			info->dtmcs_idle, info->dmi_busy_delay,
 			info->ac_busy_delay);
 }
 
+/* A batch of abstract commands completed without a busy error */
+static void ac_busy_delay_succeeded(struct target *target)
+{
+	riscv013_info_t *info = get_info(target);
+	if (busy_delay_succeeded(&info->ac_busy_delay, &info->ac_busy_control))
+		LOG_DEBUG("dtmcs_idle=%d, dmi_busy_delay=%d, ac_busy_delay=%d",
+				info->dtmcs_idle, info->dmi_busy_delay,
+				info->ac_busy_delay);
+}
+
 static uint32_t __attribute__((unused)) abstract_register_size(unsigned width)
 {
 	switch (width) {
@@ -1524,6 +1602,10 @@ static void deinit_target(struct target *target)
 	if (!info)
 		return;
 
+	riscv013_info_t *vsinfo = info->version_specific;
+	if (vsinfo && vsinfo->batch)
+		riscv_batch_free(vsinfo->batch);
+
 	free(info->version_specific);
 	/* TODO: free register arch_info */
 	info->version_specific = NULL;
@@ -1896,6 +1978,13 @@ static COMMAND_HELPER(riscv013_print_info, struct target *target)
 	riscv_print_info_line(CMD, "dm", "sbaccess16", get_field(info->sbcs, DM_SBCS_SBACCESS16));
 	riscv_print_info_line(CMD, "dm", "sbaccess8", get_field(info->sbcs, DM_SBCS_SBACCESS8));
 
+	riscv_print_info_line(CMD, "dtm", "dmi_busy_delay", info->dmi_busy_delay);
+	riscv_print_info_line(CMD, "dtm", "dmi_busy_count", info->dmi_busy_control.busy_count);
+	riscv_print_info_line(CMD, "dtm", "dmi_busy_probes", info->dmi_busy_control.probe_count);
+	riscv_print_info_line(CMD, "dtm", "ac_busy_delay", info->ac_busy_delay);
+	riscv_print_info_line(CMD, "dtm", "ac_busy_count", info->ac_busy_control.busy_count);
+	riscv_print_info_line(CMD, "dtm", "ac_busy_probes", info->ac_busy_control.probe_count);
+
 	uint32_t dmstatus;
 	if (dmstatus_read(target, &dmstatus, false) == ERROR_OK)
 		riscv_print_info_line(CMD, "dm", "authenticated", get_field(dmstatus, DM_DMSTATUS_AUTHENTICATED));
@@ -2097,13 +2186,50 @@ static int batch_run(const struct target *target, struct riscv_batch *batch)
 		r->reset_delays_wait -= batch->used_scans;
 		if (r->reset_delays_wait <= 0) {
 			batch->idle_count = 0;
-			info->dmi_busy_delay = 0;
-			info->ac_busy_delay = 0;
+			reset_busy_delays(info);
 		}
 	}
 	return riscv_batch_run(batch);
 }
 
+/* Take the batch of this target for reuse, or allocate a new one if the batch
+ * size has changed. Hand it back with put_batch(). */
+static struct riscv_batch *get_batch(struct target *target, size_t idle)
+{
+	RISCV013_INFO(info);
+	struct riscv_batch *batch = info->batch;
+
+	info->batch = NULL;
+	if (batch && riscv_batch_capacity(batch) == info->batch_scans) {
+		riscv_batch_reset(batch, idle);
+		return batch;
+	}
+	if (batch)
+		riscv_batch_free(batch);
+	return riscv_batch_alloc(target, info->batch_scans, idle);
+}
+
+static void put_batch(struct target *target, struct riscv_batch *batch)
+{
+	RISCV013_INFO(info);
+
+	if (info->batch)
+		riscv_batch_free(info->batch);
+	info->batch = batch;
+}
+
+/* Larger batches save adapter round trips, smaller ones lose less work when
+ * the target reports busy. */
+static void batch_completed(struct target *target, bool busy)
+{
+	RISCV013_INFO(info);
+
+	if (busy)
+		info->batch_scans = MAX(info->batch_scans / 2, BATCH_MIN_SCANS);
+	else
+		info->batch_scans = MIN(info->batch_scans * 2, BATCH_MAX_SCANS);
+}
+
 static int sba_supports_access(struct target *target, unsigned int size_bytes)
 {
 	RISCV013_INFO(info);
@@ -2316,10 +2442,10 @@ static int init_target(struct command_context *cmd_ctx,
 
 	info->progbufsize = -1;
 
-	info->dmi_busy_delay = 0;
+	reset_busy_delays(info);
 	info->bus_master_read_delay = 0;
 	info->bus_master_write_delay = 0;
-	info->ac_busy_delay = 0;
+	info->batch_scans = BATCH_MIN_SCANS;
 
 	/* Assume all these abstract commands are supported until we learn
 	 * otherwise.
@@ -3101,13 +3227,18 @@ static int write_memory_abstract(struct target *target, target_addr_t address,
 /**
  * Read the requested memory, taking care to execute every read exactly once,
  * even if cmderr=busy is encountered.
+ *
+ * @param resume_index Set to the number of words that were read when a DMI
+ *                     error interrupts the batched reads, -1 otherwise.
  */
-static int read_memory_progbuf_inner(struct target *target, target_addr_t address,
-		uint32_t size, uint32_t count, uint8_t *buffer, uint32_t increment)
+static int read_memory_progbuf_pipelined(struct target *target, target_addr_t address,
+		uint32_t size, uint32_t count, uint8_t *buffer, uint32_t increment,
+		int64_t *resume_index)
 {
 	RISCV013_INFO(info);
 
 	int result = ERROR_OK;
+	*resume_index = -1;
 
 	/* Write address to S0. */
 	result = register_write_direct(target, GDB_REGNO_S0, address);
@@ -3157,7 +3288,7 @@ static int read_memory_progbuf_inner(struct target *target, target_addr_t addres
 		 * dm_data0 contains[read_addr-size*2]
 		 */
 
-		struct riscv_batch *batch = riscv_batch_alloc(target, 32,
+		struct riscv_batch *batch = get_batch(target,
 				info->dmi_busy_delay + info->ac_busy_delay);
 		if (!batch)
 			return ERROR_FAIL;
@@ -3179,11 +3310,16 @@ static int read_memory_progbuf_inner(struct target *target, target_addr_t addres
 		 * and update our copy of cmderr. If we see that DMI is busy here,
 		 * dmi_busy_delay will be incremented. */
 		uint32_t abstractcs;
-		if (dmi_read(target, &abstractcs, DM_ABSTRACTCS) != ERROR_OK)
+		if (dmi_read(target, &abstractcs, DM_ABSTRACTCS) != ERROR_OK) {
+			put_batch(target, batch);
 			return ERROR_FAIL;
-		while (get_field(abstractcs, DM_ABSTRACTCS_BUSY))
-			if (dmi_read(target, &abstractcs, DM_ABSTRACTCS) != ERROR_OK)
+		}
+		while (get_field(abstractcs, DM_ABSTRACTCS_BUSY)) {
+			if (dmi_read(target, &abstractcs, DM_ABSTRACTCS) != ERROR_OK) {
+				put_batch(target, batch);
 				return ERROR_FAIL;
+			}
+		}
 		info->cmderr = get_field(abstractcs, DM_ABSTRACTCS_CMDERR);
 
 		unsigned next_index;
@@ -3191,12 +3327,14 @@ static int read_memory_progbuf_inner(struct target *target, target_addr_t addres
 		switch (info->cmderr) {
 			case CMDERR_NONE:
 				LOG_DEBUG("successful (partial?) memory read");
+				ac_busy_delay_succeeded(target);
 				next_index = index + reads;
 				break;
 			case CMDERR_BUSY:
 				LOG_DEBUG("memory read resulted in busy response");
 
 				increase_ac_busy_delay(target);
+				batch_completed(target, true);
 				riscv013_clear_abstract_error(target);
 
 				dmi_write(target, DM_ABSTRACTAUTO, 0);
@@ -3206,11 +3344,11 @@ static int read_memory_progbuf_inner(struct target *target, target_addr_t addres
 				 * attempted to read when we discovered that the target was
 				 * busy. */
 				if (dmi_read(target, &dmi_data0, DM_DATA0) != ERROR_OK) {
-					riscv_batch_free(batch);
+					put_batch(target, batch);
 					goto error;
 				}
 				if (size > 4 && dmi_read(target, &dmi_data1, DM_DATA1) != ERROR_OK) {
-					riscv_batch_free(batch);
+					put_batch(target, batch);
 					goto error;
 				}
 
@@ -3226,7 +3364,7 @@ static int read_memory_progbuf_inner(struct target *target, target_addr_t addres
 					next_index = (next_read_addr - address) / increment;
 				}
 				if (result != ERROR_OK) {
-					riscv_batch_free(batch);
+					put_batch(target, batch);
 					goto error;
 				}
 
@@ -3249,7 +3387,7 @@ static int read_memory_progbuf_inner(struct target *target, target_addr_t addres
 			default:
 				LOG_DEBUG("error when reading memory, abstractcs=0x%08lx", (long)abstractcs);
 				riscv013_clear_abstract_error(target);
-				riscv_batch_free(batch);
+				put_batch(target, batch);
 				result = ERROR_FAIL;
 				goto error;
 		}
@@ -3274,21 +3412,25 @@ static int read_memory_progbuf_inner(struct target *target, target_addr_t addres
 				 * cleared in dmi_read(). */
 				/* In at least some implementations, we issue a read, and then
 				 * can get busy back when we try to scan out the read result,
-				 * and the actual read value is lost forever. Since this is
-				 * rare in any case, we return error here and rely on our
-				 * caller to reread the entire block. */
-				LOG_WARNING("Batch memory read encountered DMI error %d. "
-						"Falling back on slower reads.", status);
-				riscv_batch_free(batch);
+				 * and the actual read value is lost forever. Everything up to
+				 * here has been stored, so let our caller restart the read
+				 * pipeline from this word. */
+				LOG_DEBUG("Batch memory read encountered DMI error %d at word %u.",
+						status, j);
+				batch_completed(target, true);
+				put_batch(target, batch);
+				*resume_index = j;
 				result = ERROR_FAIL;
 				goto error;
 			}
 			if (size > 4) {
 				status = riscv_batch_get_dmi_read_op(batch, read);
 				if (status != DMI_STATUS_SUCCESS) {
-					LOG_WARNING("Batch memory read encountered DMI error %d. "
-							"Falling back on slower reads.", status);
-					riscv_batch_free(batch);
+					LOG_DEBUG("Batch memory read encountered DMI error %d at word %u.",
+							status, j);
+					batch_completed(target, true);
+					put_batch(target, batch);
+					*resume_index = j;
 					result = ERROR_FAIL;
 					goto error;
 				}
@@ -3303,7 +3445,9 @@ static int read_memory_progbuf_inner(struct target *target, target_addr_t addres
 
 		index = next_index;
 
-		riscv_batch_free(batch);
+		if (!ignore_last)
+			batch_completed(target, false);
+		put_batch(target, batch);
 	}
 
 	dmi_write(target, DM_ABSTRACTAUTO, 0);
@@ -3336,6 +3480,35 @@ error:
 	return result;
 }
 
+/* Number of times a batched read is restarted at the same word before giving
+ * up on it. */
+#define READ_RESUME_ATTEMPTS	5
+
+static int read_memory_progbuf_inner(struct target *target, target_addr_t address,
+		uint32_t size, uint32_t count, uint8_t *buffer, uint32_t increment)
+{
+	uint32_t done = 0;
+	unsigned int attempts = 0;
+
+	while (1) {
+		int64_t resume_index;
+		int result = read_memory_progbuf_pipelined(target, address + done * increment,
+				size, count - done, buffer + done * size, increment, &resume_index);
+		if (result == ERROR_OK || resume_index < 0)
+			return result;
+
+		/* The DMI busy state has been cleared and the delays increased by now,
+		 * only the words that were not read need to be read again. */
+		if (resume_index > 0)
+			attempts = 0;
+		else if (++attempts > READ_RESUME_ATTEMPTS)
+			return result;
+		done += resume_index;
+		LOG_DEBUG("Resuming batch memory read at 0x%" TARGET_PRIxADDR,
+				address + done * increment);
+	}
+}
+
 /* Only need to save/restore one GPR to read a single word, and the progbuf
  * program doesn't need to increment. */
 static int read_memory_progbuf_one(struct target *target, target_addr_t address,
@@ -3664,9 +3837,7 @@ static int write_memory_bus_v1(struct target *target, target_addr_t address,
 		LOG_DEBUG("transferring burst starting at address 0x%" TARGET_PRIxADDR,
 				next_address);
 
-		struct riscv_batch *batch = riscv_batch_alloc(
-				target,
-				32,
+		struct riscv_batch *batch = get_batch(target,
 				info->dmi_busy_delay + info->bus_master_write_delay);
 		if (!batch)
 			return ERROR_FAIL;
@@ -3711,7 +3882,7 @@ static int write_memory_bus_v1(struct target *target, target_addr_t address,
 
 		/* Execute the batch of writes */
 		result = batch_run(target, batch);
-		riscv_batch_free(batch);
+		put_batch(target, batch);
 		if (result != ERROR_OK)
 			return result;
 
@@ -3757,6 +3928,7 @@ static int write_memory_bus_v1(struct target *target, target_addr_t address,
 				/* Fail the whole operation. */
 				return ERROR_FAIL;
 			}
+			batch_completed(target, true);
 			/* Try again - resume writing. */
 			continue;
 		}
@@ -3781,6 +3953,8 @@ static int write_memory_bus_v1(struct target *target, target_addr_t address,
 			/* Fail the whole operation */
 			return ERROR_FAIL;
 		}
+
+		batch_completed(target, false);
 	}
 
 	return ERROR_OK;
@@ -3859,9 +4033,7 @@ static int write_memory_progbuf(struct target *target, target_addr_t address,
 		LOG_DEBUG("transferring burst starting at address 0x%016" PRIx64,
 				cur_addr);
 
-		struct riscv_batch *batch = riscv_batch_alloc(
-				target,
-				32,
+		struct riscv_batch *batch = get_batch(target,
 				info->dmi_busy_delay + info->ac_busy_delay);
 		if (!batch)
 			goto error;
@@ -3881,7 +4053,7 @@ static int write_memory_progbuf(struct target *target, target_addr_t address,
 				result = register_write_direct(target, GDB_REGNO_S0,
 						address + offset);
 				if (result != ERROR_OK) {
-					riscv_batch_free(batch);
+					put_batch(target, batch);
 					goto error;
 				}
 
@@ -3899,7 +4071,7 @@ static int write_memory_progbuf(struct target *target, target_addr_t address,
 						AC_ACCESS_REGISTER_WRITE);
 				result = execute_abstract_command(target, command);
 				if (result != ERROR_OK) {
-					riscv_batch_free(batch);
+					put_batch(target, batch);
 					goto error;
 				}
 
@@ -3918,7 +4090,7 @@ static int write_memory_progbuf(struct target *target, target_addr_t address,
 		}
 
 		result = batch_run(target, batch);
-		riscv_batch_free(batch);
+		put_batch(target, batch);
 		if (result != ERROR_OK)
 			goto error;
 
@@ -3938,6 +4110,8 @@ static int write_memory_progbuf(struct target *target, target_addr_t address,
 		info->cmderr = get_field(abstractcs, DM_ABSTRACTCS_CMDERR);
 		if (info->cmderr == CMDERR_NONE && !dmi_busy_encountered) {
 			LOG_DEBUG("successful (partial?) memory write");
+			ac_busy_delay_succeeded(target);
+			batch_completed(target, false);
 		} else if (info->cmderr == CMDERR_BUSY || dmi_busy_encountered) {
 			if (info->cmderr == CMDERR_BUSY)
 				LOG_DEBUG("Memory write resulted in abstract command busy response.");
@@ -3945,6 +4119,7 @@ static int write_memory_progbuf(struct target *target, target_addr_t address,
 				LOG_DEBUG("Memory write resulted in DMI busy response.");
 			riscv013_clear_abstract_error(target);
 			increase_ac_busy_delay(target);
+			batch_completed(target, true);
 
 			dmi_write(target, DM_ABSTRACTAUTO, 0);
 			result = register_read_direct(target, &cur_addr, GDB_REGNO_S0);
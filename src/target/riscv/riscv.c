@@ -205,6 +205,10 @@ int riscv_command_timeout_sec = DEFAULT_COMMAND_TIMEOUT_SEC;
 /* Wall-clock timeout after reset. Settable via RISC-V Target commands.*/
 int riscv_reset_timeout_sec = DEFAULT_RESET_TIMEOUT_SEC;
 
+unsigned int riscv_busy_delay_probe = DEFAULT_BUSY_DELAY_PROBE;
+unsigned int riscv_busy_delay_min;
+unsigned int riscv_busy_delay_max = DEFAULT_BUSY_DELAY_MAX;
+
 static bool riscv_enable_virt2phys = true;
 bool riscv_ebreakm = true;
 bool riscv_ebreaks = true;
@@ -2727,6 +2731,37 @@ COMMAND_HANDLER(riscv_reset_delays)
 	return ERROR_OK;
 }
 
+COMMAND_HANDLER(riscv_set_busy_delay_probe)
+{
+	if (CMD_ARGC != 1) {
+		LOG_ERROR("Command takes exactly 1 parameter");
+		return ERROR_COMMAND_SYNTAX_ERROR;
+	}
+
+	COMMAND_PARSE_NUMBER(uint, CMD_ARGV[0], riscv_busy_delay_probe);
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(riscv_set_busy_delay_limits)
+{
+	if (CMD_ARGC != 2) {
+		LOG_ERROR("Command takes exactly 2 parameters");
+		return ERROR_COMMAND_SYNTAX_ERROR;
+	}
+
+	unsigned int min, max;
+	COMMAND_PARSE_NUMBER(uint, CMD_ARGV[0], min);
+	COMMAND_PARSE_NUMBER(uint, CMD_ARGV[1], max);
+	if (min > max || max > INT_MAX / 2) {
+		LOG_ERROR("Invalid busy delay limits %u..%u", min, max);
+		return ERROR_COMMAND_ARGUMENT_INVALID;
+	}
+
+	riscv_busy_delay_min = min;
+	riscv_busy_delay_max = max;
+	return ERROR_OK;
+}
+
 COMMAND_HANDLER(riscv_set_ir)
 {
 	if (CMD_ARGC != 2) {
@@ -2958,6 +2993,22 @@ static const struct command_registration riscv_exec_command_handlers[] = {
 			"command resets those learned values after `wait` scans. It's only "
 			"useful for testing OpenOCD itself."
 	},
+	{
+		.name = "set_busy_delay_probe",
+		.handler = riscv_set_busy_delay_probe,
+		.mode = COMMAND_ANY,
+		.usage = "count",
+		.help = "Try a smaller busy delay after this many successful accesses, "
+			"0 to never decrease the learned delays."
+	},
+	{
+		.name = "set_busy_delay_limits",
+		.handler = riscv_set_busy_delay_limits,
+		.mode = COMMAND_ANY,
+		.usage = "min max",
+		.help = "Set the bounds (in Run-Test/Idle cycles) of the learned "
+			"busy delays."
+	},
 	{
 		.name = "resume_order",
 		.handler = riscv_resume_order,
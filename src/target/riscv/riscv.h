@@ -24,6 +24,9 @@ struct riscv_program;
 #define DEFAULT_COMMAND_TIMEOUT_SEC		2
 #define DEFAULT_RESET_TIMEOUT_SEC		30
 
+#define DEFAULT_BUSY_DELAY_PROBE		1000
+#define DEFAULT_BUSY_DELAY_MAX			100000
+
 #define RISCV_SATP_MODE(xlen)  ((xlen) == 32 ? SATP32_MODE : SATP64_MODE)
 #define RISCV_SATP_PPN(xlen)  ((xlen) == 32 ? SATP32_PPN : SATP64_PPN)
 #define RISCV_PGSHIFT 12
@@ -255,6 +258,14 @@ extern int riscv_command_timeout_sec;
 /* Wall-clock timeout after reset. Settable via RISC-V Target commands.*/
 extern int riscv_reset_timeout_sec;
 
+/* Number of successful accesses after which a smaller busy delay is tried,
+ * 0 to never decrease the learned delays. Settable via RISC-V Target commands.*/
+extern unsigned int riscv_busy_delay_probe;
+
+/* Bounds of the learned busy delays. Settable via RISC-V Target commands.*/
+extern unsigned int riscv_busy_delay_min;
+extern unsigned int riscv_busy_delay_max;
+
 extern bool riscv_enable_virtual;
 extern bool riscv_ebreakm;
 extern bool riscv_ebreaks;
@@ -18,6 +18,31 @@
 
 #include "target.h"
 
+static void parse_rtt_channel(const uint8_t *buf, target_addr_t address,
+		struct rtt_channel *channel)
+{
+	channel->address = address;
+	channel->name_addr = buf_get_u32(buf + 0, 0, 32);
+	channel->buffer_addr = buf_get_u32(buf + 4, 0, 32);
+	channel->size = buf_get_u32(buf + 8, 0, 32);
+	channel->write_pos = buf_get_u32(buf + 12, 0, 32);
+	channel->read_pos = buf_get_u32(buf + 16, 0, 32);
+	channel->flags = buf_get_u32(buf + 20, 0, 32);
+}
+
+static target_addr_t rtt_channel_address(const struct rtt_control *ctrl,
+		unsigned int channel_index, enum rtt_channel_type type)
+{
+	target_addr_t address;
+
+	address = ctrl->address + RTT_CB_SIZE + (channel_index * RTT_CHANNEL_SIZE);
+
+	if (type == RTT_CHANNEL_TYPE_DOWN)
+		address += ctrl->num_up_channels * RTT_CHANNEL_SIZE;
+
+	return address;
+}
+
 static int read_rtt_channel(struct target *target,
 		const struct rtt_control *ctrl, unsigned int channel_index,
 		enum rtt_channel_type type, struct rtt_channel *channel)
@@ -26,23 +51,14 @@ static int read_rtt_channel(struct target *target,
 	uint8_t buf[RTT_CHANNEL_SIZE];
 	target_addr_t address;
 
-	address = ctrl->address + RTT_CB_SIZE + (channel_index * RTT_CHANNEL_SIZE);
-
-	if (type == RTT_CHANNEL_TYPE_DOWN)
-		address += ctrl->num_up_channels * RTT_CHANNEL_SIZE;
+	address = rtt_channel_address(ctrl, channel_index, type);
 
 	ret = target_read_buffer(target, address, RTT_CHANNEL_SIZE, buf);
 
 	if (ret != ERROR_OK)
 		return ret;
 
-	channel->address = address;
-	channel->name_addr = buf_get_u32(buf + 0, 0, 32);
-	channel->buffer_addr = buf_get_u32(buf + 4, 0, 32);
-	channel->size = buf_get_u32(buf + 8, 0, 32);
-	channel->write_pos = buf_get_u32(buf + 12, 0, 32);
-	channel->read_pos = buf_get_u32(buf + 16, 0, 32);
-	channel->flags = buf_get_u32(buf + 20, 0, 32);
+	parse_rtt_channel(buf, address, channel);
 
 	return ERROR_OK;
 }
@@ -243,42 +259,66 @@ int target_rtt_find_control_block(struct target *target,
 		void *user_data)
 {
 	target_addr_t address_end = *address + size;
-	uint8_t buf[1024];
+	const size_t id_length = strlen(id);
+	const size_t chunk_size = MIN(size, RTT_CB_SEARCH_CHUNK_SIZE);
+	uint8_t *buf;
 
 	*found = false;
 
-	size_t id_matched_length = 0;
-	const size_t id_length = strlen(id);
+	if (!id_length || size < id_length)
+		return ERROR_OK;
+
+	buf = malloc(chunk_size);
+
+	if (!buf) {
+		LOG_ERROR("rtt: Failed to allocate search buffer");
+		return ERROR_FAIL;
+	}
 
 	LOG_INFO("rtt: Searching for control block '%s'", id);
 
-	for (target_addr_t addr = *address; addr < address_end; addr += sizeof(buf)) {
+	target_addr_t addr = *address;
+
+	while (addr < address_end) {
 		int ret;
 
-		const size_t buf_size = MIN(sizeof(buf), address_end - addr);
+		const size_t buf_size = MIN(chunk_size, address_end - addr);
 		ret = target_read_buffer(target, addr, buf_size, buf);
 
-		if (ret != ERROR_OK)
+		if (ret != ERROR_OK) {
+			free(buf);
 			return ret;
+		}
 
-		for (size_t buf_off = 0; buf_off < buf_size; buf_off++) {
-			if (id_matched_length > 0 &&
-			    buf[buf_off] != id[id_matched_length]) {
-				/* Start from beginning */
-				id_matched_length = 0;
-			}
+		for (size_t off = 0; off + id_length <= buf_size; off++) {
+			const uint8_t *p = memchr(buf + off, id[0],
+				buf_size - id_length + 1 - off);
+
+			if (!p)
+				break;
 
-			if (buf[buf_off] == id[id_matched_length])
-				id_matched_length++;
+			off = p - buf;
 
-			if (id_matched_length == id_length) {
-				*address = addr + buf_off + 1 - id_length;
+			if (!memcmp(p, id, id_length)) {
+				*address = addr + off;
 				*found = true;
+				free(buf);
 				return ERROR_OK;
 			}
 		}
+
+		if (addr + buf_size >= address_end)
+			break;
+
+		/*
+		 * Overlap the next chunk with the tail of this one so that an ID
+		 * that straddles the chunk boundary is not missed.
+		 */
+		addr += buf_size - (id_length - 1);
 	}
 
+	free(buf);
+
 	return ERROR_OK;
 }
 
@@ -365,26 +405,54 @@ static int read_from_channel(struct target *target,
 
 int target_rtt_read_callback(struct target *target,
 		const struct rtt_control *ctrl, struct rtt_sink_list **sinks,
-		size_t num_channels, void *user_data)
+		struct rtt_channel_read_result *results, size_t num_channels,
+		void *user_data)
 {
+	int ret;
+	uint8_t *desc;
+	uint8_t *buffer = NULL;
+	size_t buffer_size = 0;
+
 	num_channels = MIN(num_channels, ctrl->num_up_channels);
 
+	/* Skip trailing channels without sinks, they need not be read. */
+	while (num_channels > 0 && !sinks[num_channels - 1])
+		num_channels--;
+
+	if (!num_channels)
+		return ERROR_OK;
+
+	desc = malloc(num_channels * RTT_CHANNEL_SIZE);
+
+	if (!desc) {
+		LOG_ERROR("rtt: Failed to allocate channel descriptors");
+		return ERROR_FAIL;
+	}
+
+	/*
+	 * The up-channel descriptors are stored back to back, fetch all of them
+	 * with a single read.
+	 */
+	ret = target_read_buffer(target,
+		rtt_channel_address(ctrl, 0, RTT_CHANNEL_TYPE_UP),
+		num_channels * RTT_CHANNEL_SIZE, desc);
+
+	if (ret != ERROR_OK) {
+		LOG_ERROR("rtt: Failed to read up-channel descriptions");
+		free(desc);
+		return ret;
+	}
+
 	for (size_t i = 0; i < num_channels; i++) {
-		int ret;
 		struct rtt_channel channel;
-		uint8_t buffer[1024];
+		uint32_t pending;
 		size_t length;
 
 		if (!sinks[i])
 			continue;
 
-		ret = read_rtt_channel(target, ctrl, i, RTT_CHANNEL_TYPE_UP,
-			&channel);
-
-		if (ret != ERROR_OK) {
-			LOG_ERROR("rtt: Failed to read up-channel %zu description", i);
-			return ret;
-		}
+		parse_rtt_channel(desc + i * RTT_CHANNEL_SIZE,
+			rtt_channel_address(ctrl, i, RTT_CHANNEL_TYPE_UP), &channel);
 
 		if (!channel_is_active(&channel)) {
 			LOG_WARNING("rtt: Up-channel %zu is not active", i);
@@ -396,17 +464,47 @@ int target_rtt_read_callback(struct target *target,
 			continue;
 		}
 
-		length = sizeof(buffer);
+		results[i].polled = true;
+		results[i].size = channel.size;
+
+		if (channel.read_pos == channel.write_pos)
+			continue;
+
+		pending = (channel.write_pos + channel.size - channel.read_pos) %
+			channel.size;
+
+		/* Drain everything that is pending, up to the channel size. */
+		length = MIN(channel.size, RTT_CHANNEL_READ_MAX_SIZE);
+
+		if (length > buffer_size) {
+			uint8_t *tmp = realloc(buffer, length);
+
+			if (!tmp) {
+				LOG_ERROR("rtt: Failed to allocate read buffer");
+				ret = ERROR_FAIL;
+				break;
+			}
+
+			buffer = tmp;
+			buffer_size = length;
+		}
+
 		ret = read_from_channel(target, &channel, buffer, &length);
 
 		if (ret != ERROR_OK) {
 			LOG_ERROR("rtt: Failed to read from up-channel %zu", i);
-			return ret;
+			break;
 		}
 
+		results[i].pending = pending;
+		results[i].length = length;
+
 		for (struct rtt_sink_list *sink = sinks[i]; sink; sink = sink->next)
 			sink->read(i, buffer, length, sink->user_data);
 	}
 
-	return ERROR_OK;
+	free(buffer);
+	free(desc);
+
+	return ret;
 }
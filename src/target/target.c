@@ -47,6 +47,7 @@
 #include "transport/transport.h"
 #include "arm_cti.h"
 #include "smp.h"
+#include "memory_cache.h"
 #include "semihosting_common.h"
 
 /* default halt wait timeout (ms) */
@@ -110,6 +111,8 @@ static struct target_type *target_types[] = {
 
 struct target *all_targets;
 static struct target_event_callback *target_event_callbacks;
+/* incremented for every event, lets handle_target() notice event handlers ran */
+static unsigned int target_event_count;
 static struct target_timer_callback *target_timer_callbacks;
 static int64_t target_timer_next_event_value;
 static LIST_HEAD(target_reset_callback_list);
@@ -514,6 +517,22 @@ struct target *get_current_target_or_null(struct command_context *cmd_ctx)
 		: cmd_ctx->current_target;
 }
 
+static void target_poll_check_halt(struct target *target)
+{
+	if (target->halt_issued) {
+		if (target->state == TARGET_HALTED)
+			target->halt_issued = false;
+		else {
+			int64_t t = timeval_ms() - target->halt_issued_time;
+			if (t > DEFAULT_HALT_TIMEOUT) {
+				target->halt_issued = false;
+				LOG_INFO("Halt timed out, wake up GDB.");
+				target_call_event_callbacks(target, TARGET_EVENT_GDB_HALT);
+			}
+		}
+	}
+}
+
 int target_poll(struct target *target)
 {
 	int retval;
@@ -528,18 +547,19 @@ int target_poll(struct target *target)
 	if (retval != ERROR_OK)
 		return retval;
 
-	if (target->halt_issued) {
-		if (target->state == TARGET_HALTED)
-			target->halt_issued = false;
-		else {
-			int64_t t = timeval_ms() - target->halt_issued_time;
-			if (t > DEFAULT_HALT_TIMEOUT) {
-				target->halt_issued = false;
-				LOG_INFO("Halt timed out, wake up GDB.");
-				target_call_event_callbacks(target, TARGET_EVENT_GDB_HALT);
-			}
-		}
-	}
+	target_poll_check_halt(target);
+
+	return ERROR_OK;
+}
+
+/* Second phase of a split poll, after the scans queued by poll_queue() ran */
+static int target_poll_complete(struct target *target, int queue_retval)
+{
+	int retval = target->type->poll_complete(target, queue_retval);
+	if (retval != ERROR_OK)
+		return retval;
+
+	target_poll_check_halt(target);
 
 	return ERROR_OK;
 }
@@ -823,6 +843,9 @@ int target_run_algorithm(struct target *target,
 		goto done;
 	}
 
+	/* the algorithm is free to modify memory */
+	target_memory_cache_invalidate_all();
+
 	target->running_alg = true;
 	retval = target->type->run_algorithm(target,
 			num_mem_params, mem_params,
@@ -863,6 +886,8 @@ int target_start_algorithm(struct target *target,
 				target_type_name(target), __func__);
 		goto done;
 	}
+
+	target_memory_cache_invalidate_all();
 	if (target->running_alg) {
 		LOG_ERROR("Target is already running an algorithm");
 		goto done;
@@ -981,6 +1006,8 @@ int target_run_flash_async_algorithm(struct target *target,
 	uint32_t fifo_start_addr = buffer_start + 8;
 	uint32_t fifo_end_addr = buffer_start + buffer_size;
 
+	target_memory_cache_invalidate_all();
+
 	uint32_t wp = fifo_start_addr;
 	uint32_t rp = fifo_start_addr;
 
@@ -1134,6 +1161,8 @@ int target_run_read_async_algorithm(struct target *target,
 	uint32_t fifo_start_addr = buffer_start + 8;
 	uint32_t fifo_end_addr = buffer_start + buffer_size;
 
+	target_memory_cache_invalidate_all();
+
 	uint32_t wp = fifo_start_addr;
 	uint32_t rp = fifo_start_addr;
 
@@ -1304,7 +1333,10 @@ int target_write_memory(struct target *target,
 		LOG_ERROR("Target %s doesn't support write_memory", target_name(target));
 		return ERROR_FAIL;
 	}
-	return target->type->write_memory(target, address, size, count, buffer);
+	int retval = target->type->write_memory(target, address, size, count, buffer);
+	target_memory_cache_written(target, address, size * count,
+			retval == ERROR_OK ? buffer : NULL);
+	return retval;
 }
 
 int target_write_phys_memory(struct target *target,
@@ -1318,6 +1350,8 @@ int target_write_phys_memory(struct target *target,
 		LOG_ERROR("Target %s doesn't support write_phys_memory", target_name(target));
 		return ERROR_FAIL;
 	}
+	/* the cache is indexed by virtual address */
+	target_memory_cache_invalidate_all();
 	return target->type->write_phys_memory(target, address, size, count, buffer);
 }
 
@@ -1783,7 +1817,7 @@ int target_unregister_timer_callback(int (*callback)(void *priv), void *priv)
 
 	for (struct target_timer_callback *c = target_timer_callbacks;
 	     c; c = c->next) {
-		if ((c->callback == callback) && (c->priv == priv)) {
+		if ((c->callback == callback) && (c->priv == priv) && !c->removed) {
 			c->removed = true;
 			return ERROR_OK;
 		}
@@ -1792,11 +1826,34 @@ int target_unregister_timer_callback(int (*callback)(void *priv), void *priv)
 	return ERROR_FAIL;
 }
 
+/**
+ * Change the interval of a registered timer callback. Unlike unregistering
+ * and registering it again, this is safe from within the callback itself:
+ * a periodic callback then next runs @a time_ms after it returns.
+ */
+int target_set_timer_callback_interval(int (*callback)(void *priv), void *priv,
+		unsigned int time_ms)
+{
+	for (struct target_timer_callback *c = target_timer_callbacks;
+	     c; c = c->next) {
+		if ((c->callback == callback) && (c->priv == priv) && !c->removed) {
+			c->time_ms = time_ms;
+			c->when = timeval_ms() + time_ms;
+			target_timer_next_event_value = MIN(target_timer_next_event_value, c->when);
+			return ERROR_OK;
+		}
+	}
+
+	return ERROR_FAIL;
+}
+
 int target_call_event_callbacks(struct target *target, enum target_event event)
 {
 	struct target_event_callback *callback = target_event_callbacks;
 	struct target_event_callback *next_callback;
 
+	target_event_count++;
+
 	if (event == TARGET_EVENT_HALTED) {
 		/* execute early halted first */
 		target_call_event_callbacks(target, TARGET_EVENT_GDB_HALT);
@@ -1806,6 +1863,22 @@ int target_call_event_callbacks(struct target *target, enum target_event event)
 			target_event_name(event),
 			target_name(target));
 
+	switch (event) {
+	case TARGET_EVENT_HALTED:
+	case TARGET_EVENT_RESUMED:
+	case TARGET_EVENT_RESUME_START:
+	case TARGET_EVENT_STEP_START:
+	case TARGET_EVENT_RESET_START:
+	case TARGET_EVENT_RESET_ASSERT_PRE:
+	case TARGET_EVENT_RESET_ASSERT:
+	case TARGET_EVENT_RESET_ASSERT_POST:
+		/* the core may have modified memory shared with other cores too */
+		target_memory_cache_invalidate_all();
+		break;
+	default:
+		break;
+	}
+
 	target_handle_event(target, event);
 
 	while (callback) {
@@ -2230,6 +2303,7 @@ static void target_destroy(struct target *target)
 	}
 
 	target_free_all_working_areas(target);
+	target_memory_cache_free(target);
 
 	/* release the targets SMP list */
 	if (target->smp) {
@@ -2388,7 +2462,10 @@ int target_write_buffer(struct target *target, target_addr_t address, uint32_t s
 		return ERROR_FAIL;
 	}
 
-	return target->type->write_buffer(target, address, size, buffer);
+	int retval = target->type->write_buffer(target, address, size, buffer);
+	target_memory_cache_written(target, address, size,
+			retval == ERROR_OK ? buffer : NULL);
+	return retval;
 }
 
 static int target_write_buffer_default(struct target *target,
@@ -2453,6 +2530,9 @@ int target_read_buffer(struct target *target, target_addr_t address, uint32_t si
 		return ERROR_FAIL;
 	}
 
+	if (target_memory_cache_usable(target, address, size))
+		return target_memory_cache_read(target, address, size, buffer);
+
 	return target->type->read_buffer(target, address, size, buffer);
 }
 
@@ -2989,6 +3069,35 @@ static int handle_target(void *priv)
 		recursive = 0;
 	}
 
+	/* Targets supporting a split-phase poll queue their status scans
+	 * first, so a single queue execution serves all of them instead of
+	 * one adapter round trip per target. The checks must match the ones
+	 * of the polling loop below.
+	 */
+	bool poll_queued = false;
+	int queue_retval = ERROR_OK;
+	for (struct target *target = all_targets; target; target = target->next) {
+		target->poll_queued = false;
+
+		if (!target->type->poll_queue || !target_was_examined(target) ||
+				!target->tap->enabled ||
+				target->backoff.times > target->backoff.count ||
+				power_dropout || srst_asserted || !is_jtag_poll_safe())
+			continue;
+
+		if (target->type->poll_queue(target) == ERROR_OK) {
+			target->poll_queued = true;
+			poll_queued = true;
+		}
+	}
+	if (poll_queued)
+		queue_retval = jtag_execute_queue();
+
+	/* Set once the status read above may no longer be current. A failed
+	 * queue execution can't be attributed to one target, so then every
+	 * target is polled on its own instead. */
+	bool poll_stale = queue_retval != ERROR_OK;
+
 	/* Poll targets for state changes unless that's globally disabled.
 	 * Skip targets that are currently disabled.
 	 */
@@ -3011,8 +3120,20 @@ static int handle_target(void *priv)
 
 		/* only poll target if we've got power and srst isn't asserted */
 		if (!power_dropout && !srst_asserted) {
+			enum target_state state = target->state;
+			unsigned int event_count = target_event_count;
+
 			/* polling may fail silently until the target has been examined */
-			retval = target_poll(target);
+			if (target->poll_queued && !poll_stale)
+				retval = target_poll_complete(target, queue_retval);
+			else
+				retval = target_poll(target);
+			target->poll_queued = false;
+
+			/* Event handlers (Tcl, SMP, GDB) may have halted or resumed
+			 * the targets polled after this one, drop their buffered status. */
+			if (target->state != state || target_event_count != event_count)
+				poll_stale = true;
 			if (retval != ERROR_OK) {
 				/* 100ms polling interval. Increase interval between polling up to 5000ms */
 				if (target->backoff.times * polling_interval < 5000) {
@@ -3618,6 +3739,9 @@ static COMMAND_HELPER(parse_load_image_command, struct image *image,
 	return ERROR_OK;
 }
 
+/* load_image reads and writes each section in chunks of this size */
+#define LOAD_IMAGE_CHUNK_SIZE	(256 * 1024)
+
 COMMAND_HANDLER(handle_load_image_command)
 {
 	uint8_t *buffer;
@@ -3640,56 +3764,75 @@ COMMAND_HANDLER(handle_load_image_command)
 	if (image_open(&image, CMD_ARGV[0], (CMD_ARGC >= 3) ? CMD_ARGV[2] : NULL) != ERROR_OK)
 		return ERROR_FAIL;
 
+	/* memory use is bounded by the chunk size, not by the section sizes */
+	buffer = malloc(LOAD_IMAGE_CHUNK_SIZE);
+	if (!buffer) {
+		command_print(CMD, "error allocating buffer (%d bytes)", LOAD_IMAGE_CHUNK_SIZE);
+		image_close(&image);
+		return ERROR_FAIL;
+	}
+
 	image_size = 0x0;
 	retval = ERROR_OK;
 	for (unsigned int i = 0; i < image.num_sections; i++) {
-		buffer = malloc(image.sections[i].size);
-		if (!buffer) {
-			command_print(CMD,
-						  "error allocating buffer for section (%d bytes)",
-						  (int)(image.sections[i].size));
-			retval = ERROR_FAIL;
-			break;
-		}
-
-		retval = image_read_section(&image, i, 0x0, image.sections[i].size, buffer, &buf_cnt);
-		if (retval != ERROR_OK) {
-			free(buffer);
-			break;
-		}
-
+		target_addr_t base_address = image.sections[i].base_address;
 		uint32_t offset = 0;
-		uint32_t length = buf_cnt;
+		uint32_t length = image.sections[i].size;
+		uint32_t written = 0;
 
 		/* DANGER!!! beware of unsigned comparison here!!! */
 
-		if ((image.sections[i].base_address + buf_cnt >= min_address) &&
-				(image.sections[i].base_address < max_address)) {
+		if ((base_address + length < min_address) ||
+				(base_address >= max_address))
+			continue;
 
-			if (image.sections[i].base_address < min_address) {
-				/* clip addresses below */
-				offset += min_address-image.sections[i].base_address;
-				length -= offset;
-			}
+		if (base_address < min_address) {
+			/* clip addresses below */
+			offset += min_address - base_address;
+			length -= offset;
+		}
 
-			if (image.sections[i].base_address + buf_cnt > max_address)
-				length -= (image.sections[i].base_address + buf_cnt)-max_address;
+		if (base_address + image.sections[i].size > max_address)
+			length -= (base_address + image.sections[i].size) - max_address;
+
+		/* only the part of the section being loaded is read from the image */
+		while (written < length) {
+			uint32_t chunk = MIN(length - written, LOAD_IMAGE_CHUNK_SIZE);
+			const uint8_t *data;
+
+			/* write straight from the image if possible, else copy */
+			if (image_section_view(&image, i, offset + written, chunk, &data) == ERROR_OK) {
+				buf_cnt = chunk;
+			} else {
+				retval = image_read_section(&image, i, offset + written, chunk, buffer, &buf_cnt);
+				if (retval != ERROR_OK)
+					break;
+				data = buffer;
+			}
 
 			retval = target_write_buffer(target,
-					image.sections[i].base_address + offset, length, buffer + offset);
-			if (retval != ERROR_OK) {
-				free(buffer);
+					base_address + offset + written, buf_cnt, data);
+			if (retval != ERROR_OK)
 				break;
-			}
-			image_size += length;
-			command_print(CMD, "%u bytes written at address " TARGET_ADDR_FMT "",
-					(unsigned int)length,
-					image.sections[i].base_address + offset);
+			written += buf_cnt;
+
+			/* the section has no more data in the image file */
+			if (buf_cnt < chunk)
+				break;
+
+			keep_alive();
 		}
+		if (retval != ERROR_OK)
+			break;
 
-		free(buffer);
+		image_size += written;
+		command_print(CMD, "%u bytes written at address " TARGET_ADDR_FMT "",
+				(unsigned int)written,
+				base_address + offset);
 	}
 
+	free(buffer);
+
 	if ((retval == ERROR_OK) && (duration_measure(&bench) == ERROR_OK)) {
 		command_print(CMD, "downloaded %" PRIu32 " bytes "
 				"in %fs (%0.3f KiB/s)", image_size,
@@ -3702,6 +3845,14 @@ COMMAND_HANDLER(handle_load_image_command)
 
 }
 
+/* dump_image reads the target in chunks of this size */
+#define DUMP_IMAGE_CHUNK_SIZE	(64 * 1024)
+
+static bool dump_image_chunk_is_zero(const uint8_t *buffer, size_t size)
+{
+	return buffer[0] == 0 && !memcmp(buffer, buffer + 1, size - 1);
+}
+
 COMMAND_HANDLER(handle_dump_image_command)
 {
 	struct fileio *fileio;
@@ -3710,6 +3861,13 @@ COMMAND_HANDLER(handle_dump_image_command)
 	target_addr_t address, size;
 	struct duration bench;
 	struct target *target = get_current_target(CMD_CTX);
+	bool sparse = false;
+
+	if (CMD_ARGC == 4 && strcmp(CMD_ARGV[0], "-sparse") == 0) {
+		sparse = true;
+		CMD_ARGC--;
+		CMD_ARGV++;
+	}
 
 	if (CMD_ARGC != 3)
 		return ERROR_COMMAND_SYNTAX_ERROR;
@@ -3717,7 +3875,7 @@ COMMAND_HANDLER(handle_dump_image_command)
 	COMMAND_PARSE_ADDRESS(CMD_ARGV[1], address);
 	COMMAND_PARSE_ADDRESS(CMD_ARGV[2], size);
 
-	uint32_t buf_size = (size > 4096) ? 4096 : size;
+	uint32_t buf_size = (size > DUMP_IMAGE_CHUNK_SIZE) ? DUMP_IMAGE_CHUNK_SIZE : size;
 	buffer = malloc(buf_size);
 	if (!buffer)
 		return ERROR_FAIL;
@@ -3730,6 +3888,9 @@ COMMAND_HANDLER(handle_dump_image_command)
 
 	duration_start(&bench);
 
+	/* with -sparse, all-zero chunks are seeked over instead of written */
+	size_t offset = 0;
+	bool hole = false;
 	while (size > 0) {
 		size_t size_written;
 		uint32_t this_run_size = (size > buf_size) ? buf_size : size;
@@ -3737,24 +3898,40 @@ COMMAND_HANDLER(handle_dump_image_command)
 		if (retval != ERROR_OK)
 			break;
 
-		retval = fileio_write(fileio, this_run_size, buffer, &size_written);
-		if (retval != ERROR_OK)
-			break;
+		if (sparse && dump_image_chunk_is_zero(buffer, this_run_size)) {
+			hole = true;
+		} else {
+			if (hole) {
+				retval = fileio_seek(fileio, offset);
+				if (retval != ERROR_OK)
+					break;
+				hole = false;
+			}
+			retval = fileio_write(fileio, this_run_size, buffer, &size_written);
+			if (retval != ERROR_OK)
+				break;
+		}
 
 		size -= this_run_size;
 		address += this_run_size;
+		offset += this_run_size;
+		keep_alive();
+	}
+
+	/* a trailing hole still has to extend the file to its full size */
+	if (retval == ERROR_OK && hole) {
+		size_t size_written;
+		retval = fileio_seek(fileio, offset - 1);
+		if (retval == ERROR_OK)
+			retval = fileio_write(fileio, 1, buffer, &size_written);
 	}
 
 	free(buffer);
 
 	if ((retval == ERROR_OK) && (duration_measure(&bench) == ERROR_OK)) {
-		size_t filesize;
-		retval = fileio_size(fileio, &filesize);
-		if (retval != ERROR_OK)
-			return retval;
 		command_print(CMD,
-				"dumped %zu bytes in %fs (%0.3f KiB/s)", filesize,
-				duration_elapsed(&bench), duration_kbps(&bench, filesize));
+				"dumped %zu bytes in %fs (%0.3f KiB/s)", offset,
+				duration_elapsed(&bench), duration_kbps(&bench, offset));
 	}
 
 	retvaltemp = fileio_close(fileio);
@@ -3770,6 +3947,83 @@ enum verify_mode {
 	IMAGE_CHECKSUM_ONLY = 2
 };
 
+/* Contiguous sections are checksummed together up to this size */
+#define VERIFY_BATCH_SIZE		0x10000
+/* Checksum mismatches are narrowed down to blocks of this size before reading back */
+#define VERIFY_COMPARE_SIZE		0x1000
+#define VERIFY_MAX_DIFFS		128
+
+static int verify_image_compare(struct command_invocation *cmd, struct target *target,
+		target_addr_t address, const uint8_t *buffer, uint32_t size, int *diffs)
+{
+	uint8_t *data = malloc(size);
+	if (!data) {
+		LOG_ERROR("error allocating buffer for compare (%" PRIu32 " bytes)", size);
+		return ERROR_FAIL;
+	}
+
+	int retval = target_read_buffer(target, address, size, data);
+	if (retval == ERROR_OK) {
+		for (uint32_t t = 0; t < size; t++) {
+			if (data[t] != buffer[t]) {
+				command_print(CMD,
+							  "diff %d address 0x%08x. Was 0x%02x instead of 0x%02x",
+							  *diffs,
+							  (unsigned)(t + address),
+							  data[t],
+							  buffer[t]);
+				if ((*diffs)++ >= VERIFY_MAX_DIFFS - 1) {
+					command_print(CMD, "More than %d errors, the rest are not printed.",
+							VERIFY_MAX_DIFFS);
+					break;
+				}
+			}
+		}
+	}
+
+	free(data);
+	return retval;
+}
+
+/* Find the differences in a block whose checksum does not match by checksumming
+ * its halves, so only the differing parts are read back. */
+static int verify_image_bisect(struct command_invocation *cmd, struct target *target,
+		target_addr_t address, const uint8_t *buffer, uint32_t size, int *diffs)
+{
+	uint32_t checksum, mem_checksum;
+	int retval;
+
+	keep_alive();
+
+	if (size <= VERIFY_COMPARE_SIZE)
+		return verify_image_compare(cmd, target, address, buffer, size, diffs);
+
+	/* keep the halves word aligned for the target checksum algorithms */
+	uint32_t half = (size / 2) & ~3u;
+
+	retval = image_calculate_checksum(buffer, half, &checksum);
+	if (retval == ERROR_OK)
+		retval = target_checksum_memory(target, address, half, &mem_checksum);
+	if (retval != ERROR_OK)
+		return retval;
+
+	bool first_differs = checksum != mem_checksum;
+	if (first_differs) {
+		retval = verify_image_bisect(cmd, target, address, buffer, half, diffs);
+		if (retval != ERROR_OK || *diffs >= VERIFY_MAX_DIFFS)
+			return retval;
+
+		retval = image_calculate_checksum(buffer + half, size - half, &checksum);
+		if (retval == ERROR_OK)
+			retval = target_checksum_memory(target, address + half, size - half, &mem_checksum);
+		if (retval != ERROR_OK || checksum == mem_checksum)
+			return retval;
+	}
+	/* else the whole block differs, so the second half must */
+
+	return verify_image_bisect(cmd, target, address + half, buffer + half, size - half, diffs);
+}
+
 static COMMAND_HELPER(handle_verify_image_command_internal, enum verify_mode verify)
 {
 	uint8_t *buffer;
@@ -3813,29 +4067,62 @@ static COMMAND_HELPER(handle_verify_image_command_internal, enum verify_mode ver
 	image_size = 0x0;
 	int diffs = 0;
 	retval = ERROR_OK;
-	for (unsigned int i = 0; i < image.num_sections; i++) {
-		buffer = malloc(image.sections[i].size);
-		if (!buffer) {
-			command_print(CMD,
-					"error allocating buffer for section (%" PRIu32 " bytes)",
-					image.sections[i].size);
-			break;
+	for (unsigned int i = 0; i < image.num_sections; ) {
+		target_addr_t address = image.sections[i].base_address;
+		uint32_t size = image.sections[i].size;
+		unsigned int count = 1;
+
+		/* Run the target checksum algorithm once for small contiguous
+		 * sections, its setup costs more than checksumming them. */
+		if (verify >= IMAGE_VERIFY) {
+			while (i + count < image.num_sections
+					&& image.sections[i + count].base_address == address + size
+					&& size + image.sections[i + count].size <= VERIFY_BATCH_SIZE) {
+				size += image.sections[i + count].size;
+				count++;
+			}
 		}
-		retval = image_read_section(&image, i, 0x0, image.sections[i].size, buffer, &buf_cnt);
-		if (retval != ERROR_OK) {
-			free(buffer);
-			break;
+
+		const uint8_t *data;
+		buffer = NULL;
+		if (count == 1 && image_section_view(&image, i, 0x0, size, &data) == ERROR_OK) {
+			buf_cnt = size;
+		} else {
+			buffer = malloc(size);
+			if (!buffer) {
+				command_print(CMD,
+						"error allocating buffer for section (%" PRIu32 " bytes)",
+						size);
+				break;
+			}
+
+			buf_cnt = 0;
+			for (unsigned int j = i; j < i + count; j++) {
+				size_t cnt;
+				retval = image_read_section(&image, j, 0x0, image.sections[j].size, buffer + buf_cnt, &cnt);
+				if (retval != ERROR_OK)
+					break;
+				buf_cnt += cnt;
+				/* a short read ends the batch, the next section would not be contiguous */
+				if (cnt != image.sections[j].size)
+					count = j - i + 1;
+			}
+			if (retval != ERROR_OK) {
+				free(buffer);
+				break;
+			}
+			data = buffer;
 		}
 
 		if (verify >= IMAGE_VERIFY) {
 			/* calculate checksum of image */
-			retval = image_calculate_checksum(buffer, buf_cnt, &checksum);
+			retval = image_calculate_checksum(data, buf_cnt, &checksum);
 			if (retval != ERROR_OK) {
 				free(buffer);
 				break;
 			}
 
-			retval = target_checksum_memory(target, image.sections[i].base_address, buf_cnt, &mem_checksum);
+			retval = target_checksum_memory(target, address, buf_cnt, &mem_checksum);
 			if (retval != ERROR_OK) {
 				free(buffer);
 				break;
@@ -3848,44 +4135,24 @@ static COMMAND_HELPER(handle_verify_image_command_internal, enum verify_mode ver
 			}
 			if (checksum != mem_checksum) {
 				/* failed crc checksum, fall back to a binary compare */
-				uint8_t *data;
-
 				if (diffs == 0)
 					LOG_ERROR("checksum mismatch - attempting binary compare");
 
-				data = malloc(buf_cnt);
-
-				retval = target_read_buffer(target, image.sections[i].base_address, buf_cnt, data);
-				if (retval == ERROR_OK) {
-					uint32_t t;
-					for (t = 0; t < buf_cnt; t++) {
-						if (data[t] != buffer[t]) {
-							command_print(CMD,
-										  "diff %d address 0x%08x. Was 0x%02x instead of 0x%02x",
-										  diffs,
-										  (unsigned)(t + image.sections[i].base_address),
-										  data[t],
-										  buffer[t]);
-							if (diffs++ >= 127) {
-								command_print(CMD, "More than 128 errors, the rest are not printed.");
-								free(data);
-								free(buffer);
-								goto done;
-							}
-						}
-						keep_alive();
-					}
+				retval = verify_image_bisect(CMD, target, address, data, buf_cnt, &diffs);
+				if (retval != ERROR_OK || diffs >= VERIFY_MAX_DIFFS) {
+					free(buffer);
+					goto done;
 				}
-				free(data);
 			}
 		} else {
 			command_print(CMD, "address " TARGET_ADDR_FMT " length 0x%08zx",
-						  image.sections[i].base_address,
+						  address,
 						  buf_cnt);
 		}
 
 		free(buffer);
 		image_size += buf_cnt;
+		i += count;
 	}
 	if (diffs > 0)
 		command_print(CMD, "No more differences found.");
@@ -5099,36 +5366,59 @@ static int target_jim_get_reg(Jim_Interp *interp, int argc,
 	assert(cmd_ctx != NULL);
 	const struct target *target = get_current_target(cmd_ctx);
 
+	struct reg **regs = calloc(length, sizeof(*regs));
+
+	if (length && !regs) {
+		LOG_ERROR("Failed to allocate memory");
+		return JIM_ERR;
+	}
+
 	for (int i = 0; i < length; i++) {
 		Jim_Obj *elem = Jim_ListGetIndex(interp, argv[1], i);
 
-		if (!elem)
+		if (!elem) {
+			free(regs);
 			return JIM_ERR;
+		}
 
 		const char *reg_name = Jim_String(elem);
 
-		struct reg *reg = register_get_by_name(target->reg_cache, reg_name,
-			false);
+		regs[i] = register_get_by_name(target->reg_cache, reg_name, false);
 
-		if (!reg || !reg->exist) {
+		if (!regs[i] || !regs[i]->exist) {
 			Jim_SetResultFormatted(interp, "unknown register '%s'", reg_name);
+			free(regs);
 			return JIM_ERR;
 		}
 
-		if (force) {
-			int retval = reg->type->get(reg);
+		/* invalid registers are read below, all together */
+		if (force && regs[i]->valid) {
+			int retval = regs[i]->type->get(regs[i]);
 
 			if (retval != ERROR_OK) {
 				Jim_SetResultFormatted(interp, "failed to read register '%s'",
 					reg_name);
+				free(regs);
 				return JIM_ERR;
 			}
 		}
+	}
+
+	if (force && register_get_multiple(regs, length) != ERROR_OK) {
+		Jim_SetResultString(interp, "failed to read registers", -1);
+		free(regs);
+		return JIM_ERR;
+	}
+
+	for (int i = 0; i < length; i++) {
+		Jim_Obj *elem = Jim_ListGetIndex(interp, argv[1], i);
+		struct reg *reg = regs[i];
 
 		char *reg_value = buf_to_hex_str(reg->value, reg->size);
 
 		if (!reg_value) {
 			LOG_ERROR("Failed to allocate memory");
+			free(regs);
 			return JIM_ERR;
 		}
 
@@ -5138,6 +5428,7 @@ static int target_jim_get_reg(Jim_Interp *interp, int argc,
 
 		if (!tmp) {
 			LOG_ERROR("Failed to allocate memory");
+			free(regs);
 			return JIM_ERR;
 		}
 
@@ -5147,6 +5438,7 @@ static int target_jim_get_reg(Jim_Interp *interp, int argc,
 		free(tmp);
 	}
 
+	free(regs);
 	Jim_SetResult(interp, result_dict);
 
 	return JIM_OK;
@@ -6054,6 +6346,13 @@ static const struct command_registration target_instance_command_handlers[] = {
 		.help = "invoke handler for specified event",
 		.usage = "event_name",
 	},
+	{
+		.name = "mem_cache",
+		.mode = COMMAND_ANY,
+		.help = "host side cache of target memory reads",
+		.usage = "",
+		.chain = target_memory_cache_command_handlers,
+	},
 	COMMAND_REGISTRATION_DONE
 };
 
@@ -7060,7 +7359,7 @@ static const struct command_registration target_exec_command_handlers[] = {
 		.name = "dump_image",
 		.handler = handle_dump_image_command,
 		.mode = COMMAND_EXEC,
-		.usage = "filename address size",
+		.usage = "['-sparse'] filename address size",
 	},
 	{
 		.name = "verify_image_checksum",
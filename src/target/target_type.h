@@ -32,6 +32,18 @@ struct target_type {
 
 	/* poll current target status */
 	int (*poll)(struct target *target);
+
+	/**
+	 * Optional split-phase version of poll(), used by the periodic polling
+	 * so that the status scans of all targets are run by one execution of
+	 * the JTAG queue. poll_queue() only queues the scans reading the target
+	 * status, it must not execute the queue. poll_complete() is called
+	 * after the queue has been executed, with the result of the execution,
+	 * and then does what poll() does with the status read.
+	 * Targets implementing these must still implement poll().
+	 */
+	int (*poll_queue)(struct target *target);
+	int (*poll_complete)(struct target *target, int queue_retval);
 	/* Invoked only from target_arch_state().
 	 * Issue USER() w/architecture specific status.  */
 	int (*arch_state)(struct target *target);
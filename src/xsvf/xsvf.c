@@ -111,6 +111,43 @@ TDO  (1);
 
 static int xsvf_fd;
 
+/* the file is read in large blocks instead of one read() per byte */
+#define XSVF_READ_BUFFER_SIZE	(64 * 1024)
+static uint8_t xsvf_read_buf[XSVF_READ_BUFFER_SIZE];
+static size_t xsvf_read_pos, xsvf_read_len;
+/* file offset of the first byte in xsvf_read_buf */
+static off_t xsvf_read_offset;
+
+static int xsvf_read(void *buf, size_t len)
+{
+	uint8_t *dst = buf;
+
+	while (len > 0) {
+		if (xsvf_read_pos == xsvf_read_len) {
+			ssize_t n = read(xsvf_fd, xsvf_read_buf, XSVF_READ_BUFFER_SIZE);
+			if (n <= 0)
+				return ERROR_XSVF_EOF;
+			xsvf_read_offset += xsvf_read_len;
+			xsvf_read_pos = 0;
+			xsvf_read_len = n;
+		}
+
+		size_t chunk = MIN(len, xsvf_read_len - xsvf_read_pos);
+		memcpy(dst, xsvf_read_buf + xsvf_read_pos, chunk);
+		xsvf_read_pos += chunk;
+		dst += chunk;
+		len -= chunk;
+	}
+
+	return ERROR_OK;
+}
+
+/* offset in the file of the next byte xsvf_read() returns */
+static off_t xsvf_tell(void)
+{
+	return xsvf_read_offset + xsvf_read_pos;
+}
+
 /* map xsvf tap state to an openocd "tap_state_t" */
 static tap_state_t xsvf_to_tap(int xsvf_state)
 {
@@ -173,19 +210,39 @@ static tap_state_t xsvf_to_tap(int xsvf_state)
 	return ret;
 }
 
-static int xsvf_read_buffer(int num_bits, int fd, uint8_t *buf)
+static int xsvf_read_buffer(int num_bits, uint8_t *buf)
 {
-	int num_bytes;
+	int num_bytes = (num_bits + 7) / 8;
+
+	if (xsvf_read(buf, num_bytes) != ERROR_OK)
+		return ERROR_XSVF_EOF;
 
-	for (num_bytes = (num_bits + 7) / 8; num_bytes > 0; num_bytes--) {
-		/* reverse the order of bytes as they are read sequentially from file */
-		if (read(fd, buf + num_bytes - 1, 1) < 0)
-			return ERROR_XSVF_EOF;
+	/* reverse the order of bytes as they are read sequentially from file */
+	for (int i = 0, j = num_bytes - 1; i < j; i++, j--) {
+		uint8_t tmp = buf[i];
+		buf[i] = buf[j];
+		buf[j] = tmp;
 	}
 
 	return ERROR_OK;
 }
 
+/* true if no bit of the TDO mask is set, so the TDO compare can not fail */
+static bool xsvf_mask_is_zero(const uint8_t *mask, int num_bits)
+{
+	int num_bytes = num_bits / 8;
+
+	for (int i = 0; i < num_bytes; i++) {
+		if (mask[i])
+			return false;
+	}
+
+	if (num_bits % 8)
+		return !(mask[num_bytes] & ((1 << (num_bits % 8)) - 1));
+
+	return true;
+}
+
 COMMAND_HANDLER(handle_xsvf_command)
 {
 	uint8_t *dr_out_buf = NULL;				/* from host to device (TDI) */
@@ -212,6 +269,8 @@ COMMAND_HANDLER(handle_xsvf_command)
 	int do_abort = 0;
 	int unsupported = 0;
 	int tdo_mismatch = 0;
+	int queue_error = 0;
+	bool check_tdo = true;
 	int result;
 	int verbose = 1;
 
@@ -249,6 +308,9 @@ COMMAND_HANDLER(handle_xsvf_command)
 		command_print(CMD, "file \"%s\" not found", filename);
 		return ERROR_FAIL;
 	}
+	xsvf_read_pos = 0;
+	xsvf_read_len = 0;
+	xsvf_read_offset = 0;
 
 	/* if this argument is present, then interpret xruntest counts as TCK cycles rather than as
 	 *usecs */
@@ -264,9 +326,9 @@ COMMAND_HANDLER(handle_xsvf_command)
 	LOG_WARNING("XSVF support in OpenOCD is limited. Consider using SVF instead");
 	LOG_USER("xsvf processing file: \"%s\"", filename);
 
-	while (read(xsvf_fd, &opcode, 1) > 0) {
+	while (xsvf_read(&opcode, 1) == ERROR_OK) {
 		/* record the position of this opcode within the file */
-		file_offset = lseek(xsvf_fd, 0, SEEK_CUR) - 1;
+		file_offset = xsvf_tell() - 1;
 
 		/* maybe collect another state for a pathmove();
 		 * or terminate a path.
@@ -286,7 +348,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 						break;
 					}
 
-					if (read(xsvf_fd, &uc, 1) < 0) {
+					if (xsvf_read(&uc, 1) != ERROR_OK) {
 						do_abort = 1;
 						break;
 					}
@@ -334,12 +396,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 					else
 						jtag_add_pathmove(pathlen, path);
 
-					result = jtag_execute_queue();
-					if (result != ERROR_OK) {
-						LOG_ERROR("XSVF: pathmove error %d", result);
-						do_abort = 1;
-						break;
-					}
+					/* queue errors are reported by the next flush */
 					continue;
 			}
 		}
@@ -350,23 +407,26 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 				result = jtag_execute_queue();
 				if (result != ERROR_OK) {
-					tdo_mismatch = 1;
+					queue_error = 1;
 					break;
 				}
 				break;
 
 			case XTDOMASK:
 				LOG_DEBUG("XTDOMASK");
-				if (dr_in_mask &&
-						(xsvf_read_buffer(xsdrsize, xsvf_fd, dr_in_mask) != ERROR_OK))
-					do_abort = 1;
+				if (dr_in_mask) {
+					if (xsvf_read_buffer(xsdrsize, dr_in_mask) != ERROR_OK)
+						do_abort = 1;
+					else
+						check_tdo = !xsvf_mask_is_zero(dr_in_mask, xsdrsize);
+				}
 				break;
 
 			case XRUNTEST:
 			{
 				uint8_t xruntest_buf[4];
 
-				if (read(xsvf_fd, xruntest_buf, 4) < 0) {
+				if (xsvf_read(xruntest_buf, 4) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
@@ -380,7 +440,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 			{
 				uint8_t myrepeat;
 
-				if (read(xsvf_fd, &myrepeat, 1) < 0)
+				if (xsvf_read(&myrepeat, 1) != ERROR_OK)
 					do_abort = 1;
 				else {
 					xrepeat = myrepeat;
@@ -393,7 +453,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 			{
 				uint8_t xsdrsize_buf[4];
 
-				if (read(xsvf_fd, xsdrsize_buf, 4) < 0) {
+				if (xsvf_read(xsdrsize_buf, 4) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
@@ -408,6 +468,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 				dr_out_buf = malloc((xsdrsize + 7) / 8);
 				dr_in_buf = malloc((xsdrsize + 7) / 8);
 				dr_in_mask = malloc((xsdrsize + 7) / 8);
+				check_tdo = true;
 			}
 			break;
 
@@ -420,13 +481,13 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 				const char *op_name = (opcode == XSDR ? "XSDR" : "XSDRTDO");
 
-				if (xsvf_read_buffer(xsdrsize, xsvf_fd, dr_out_buf) != ERROR_OK) {
+				if (xsvf_read_buffer(xsdrsize, dr_out_buf) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
 
 				if (opcode == XSDRTDO) {
-					if (xsvf_read_buffer(xsdrsize, xsvf_fd,
+					if (xsvf_read_buffer(xsdrsize,
 						dr_in_buf)  != ERROR_OK) {
 						do_abort = 1;
 						break;
@@ -438,6 +499,37 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 				LOG_DEBUG("%s %d", op_name, xsdrsize);
 
+				if (!check_tdo) {
+					/* TDO is fully masked: the compare can't fail and
+					 * nothing depends on the result, so leave the scan
+					 * in the queue with the following operations.
+					 */
+					struct scan_field field = {
+						.num_bits = xsdrsize,
+						.out_value = dr_out_buf,
+					};
+
+					if (!tap)
+						jtag_add_plain_dr_scan(field.num_bits,
+								field.out_value, NULL, TAP_DRPAUSE);
+					else
+						jtag_add_dr_scan(tap, 1, &field, TAP_DRPAUSE);
+
+					matched = 1;
+					limit = 0;
+				} else {
+					/* flush the operations deferred so far on their own,
+					 * so that their errors are neither retried nor taken
+					 * for a mismatch of this scan
+					 */
+					result = jtag_execute_queue();
+					if (result != ERROR_OK) {
+						LOG_ERROR("queued operations before %s failed", op_name);
+						queue_error = 1;
+						break;
+					}
+				}
+
 				for (attempt = 0; attempt < limit; ++attempt) {
 					struct scan_field field;
 
@@ -565,7 +657,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 			{
 				tap_state_t mystate;
 
-				if (read(xsvf_fd, &uc, 1) < 0) {
+				if (xsvf_read(&uc, 1) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
@@ -608,7 +700,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 			case XENDIR:
 
-				if (read(xsvf_fd, &uc, 1) < 0) {
+				if (xsvf_read(&uc, 1) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
@@ -629,7 +721,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 			case XENDDR:
 
-				if (read(xsvf_fd, &uc, 1) < 0) {
+				if (xsvf_read(&uc, 1) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
@@ -658,14 +750,14 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 				if (opcode == XSIR) {
 					/* one byte bitcount */
-					if (read(xsvf_fd, short_buf, 1) < 0) {
+					if (xsvf_read(short_buf, 1) != ERROR_OK) {
 						do_abort = 1;
 						break;
 					}
 					bitcount = short_buf[0];
 					LOG_DEBUG("XSIR %d", bitcount);
 				} else {
-					if (read(xsvf_fd, short_buf, 2) < 0) {
+					if (xsvf_read(short_buf, 2) != ERROR_OK) {
 						do_abort = 1;
 						break;
 					}
@@ -675,7 +767,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 				ir_buf = malloc((bitcount + 7) / 8);
 
-				if (xsvf_read_buffer(bitcount, xsvf_fd, ir_buf) != ERROR_OK)
+				if (xsvf_read_buffer(bitcount, ir_buf) != ERROR_OK)
 					do_abort = 1;
 				else {
 					struct scan_field field;
@@ -698,15 +790,13 @@ COMMAND_HANDLER(handle_xsvf_command)
 							jtag_add_sleep(xruntest);
 					}
 
-					/* Note that an -irmask of non-zero in your config file
-					 * can cause this to fail.  Setting -irmask to zero cand work
+					/* Nothing is read back, the queue is executed by the
+					 * next TDO compare or XCOMPLETE.
+					 *
+					 * Note that an -irmask of non-zero in your config file
+					 * can cause that to fail.  Setting -irmask to zero cand work
 					 * around the problem.
 					 */
-
-					/* LOG_DEBUG("FLUSHING QUEUE"); */
-					result = jtag_execute_queue();
-					if (result != ERROR_OK)
-						tdo_mismatch = 1;
 				}
 				free(ir_buf);
 			}
@@ -718,7 +808,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 				char comment[128];
 
 				do {
-					if (read(xsvf_fd, &uc, 1) < 0) {
+					if (xsvf_read(&uc, 1) != ERROR_OK) {
 						do_abort = 1;
 						break;
 					}
@@ -748,9 +838,9 @@ COMMAND_HANDLER(handle_xsvf_command)
 				tap_state_t end_state;
 				int delay;
 
-				if (read(xsvf_fd, &wait_local, 1) < 0
-					|| read(xsvf_fd, &end, 1) < 0
-					|| read(xsvf_fd, delay_buf, 4) < 0) {
+				if (xsvf_read(&wait_local, 1) != ERROR_OK
+					|| xsvf_read(&end, 1) != ERROR_OK
+					|| xsvf_read(delay_buf, 4) != ERROR_OK) {
 						do_abort = 1;
 						break;
 				}
@@ -793,10 +883,10 @@ COMMAND_HANDLER(handle_xsvf_command)
 				int clock_count;
 				int usecs;
 
-				if (read(xsvf_fd, &wait_local, 1) < 0
-						||  read(xsvf_fd, &end, 1) < 0
-						||  read(xsvf_fd, clock_buf, 4) < 0
-						||  read(xsvf_fd, usecs_buf, 4) < 0) {
+				if (xsvf_read(&wait_local, 1) != ERROR_OK
+						||  xsvf_read(&end, 1) != ERROR_OK
+						||  xsvf_read(clock_buf, 4) != ERROR_OK
+						||  xsvf_read(usecs_buf, 4) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
@@ -845,7 +935,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 				*/
 				uint8_t count_buf[4];
 
-				if (read(xsvf_fd, count_buf, 4) < 0) {
+				if (xsvf_read(count_buf, 4) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
@@ -864,9 +954,9 @@ COMMAND_HANDLER(handle_xsvf_command)
 				uint8_t clock_buf[4];
 				uint8_t usecs_buf[4];
 
-				if (read(xsvf_fd, &state, 1) < 0
-						|| read(xsvf_fd, clock_buf, 4) < 0
-						|| read(xsvf_fd, usecs_buf, 4) < 0) {
+				if (xsvf_read(&state, 1) != ERROR_OK
+						|| xsvf_read(clock_buf, 4) != ERROR_OK
+						|| xsvf_read(usecs_buf, 4) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
@@ -892,8 +982,8 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 				LOG_DEBUG("LSDR");
 
-				if (xsvf_read_buffer(xsdrsize, xsvf_fd, dr_out_buf) != ERROR_OK
-						|| xsvf_read_buffer(xsdrsize, xsvf_fd, dr_in_buf) != ERROR_OK) {
+				if (xsvf_read_buffer(xsdrsize, dr_out_buf) != ERROR_OK
+						|| xsvf_read_buffer(xsdrsize, dr_in_buf) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
@@ -901,6 +991,14 @@ COMMAND_HANDLER(handle_xsvf_command)
 				if (limit < 1)
 					limit = 1;
 
+				/* as for XSDRTDO, don't retry errors of deferred operations */
+				result = jtag_execute_queue();
+				if (result != ERROR_OK) {
+					LOG_ERROR("queued operations before LSDR failed");
+					queue_error = 1;
+					break;
+				}
+
 				for (attempt = 0; attempt < limit; ++attempt) {
 					struct scan_field field;
 
@@ -952,7 +1050,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 			{
 				uint8_t trst_mode;
 
-				if (read(xsvf_fd, &trst_mode, 1) < 0) {
+				if (xsvf_read(&trst_mode, 1) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
@@ -979,7 +1077,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 				unsupported = 1;
 		}
 
-		if (do_abort || unsupported || tdo_mismatch) {
+		if (do_abort || unsupported || tdo_mismatch || queue_error) {
 			LOG_DEBUG("xsvf failed, setting taps to reasonable state");
 
 			/* upon error, return the TAPs to a reasonable state */
@@ -993,6 +1091,21 @@ COMMAND_HANDLER(handle_xsvf_command)
 		}
 	}
 
+	/* execute whatever is still queued if the file lacks XCOMPLETE */
+	if (!do_abort && !unsupported && !tdo_mismatch && !queue_error) {
+		result = jtag_execute_queue();
+		if (result != ERROR_OK)
+			queue_error = 1;
+	}
+
+	if (queue_error) {
+		command_print(CMD,
+			"JTAG queue error, somewhere before offset %lu in xsvf file, aborting",
+			file_offset);
+
+		return ERROR_FAIL;
+	}
+
 	if (tdo_mismatch) {
 		command_print(CMD,
 			"TDO mismatch, somewhere near offset %lu in xsvf file, aborting",
@@ -1002,7 +1115,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 	}
 
 	if (unsupported) {
-		off_t offset = lseek(xsvf_fd, 0, SEEK_CUR) - 1;
+		off_t offset = xsvf_tell() - 1;
 		command_print(CMD,
 			"unsupported xsvf command (0x%02X) at offset %jd, aborting",
 			uc, (intmax_t)offset);
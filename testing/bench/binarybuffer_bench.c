@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+  Microbenchmark of the bit buffer helpers in src/helper/binarybuffer.c/.h.
+  It checks that the current buf_set_u32/u64(), buf_get_u32/u64(),
+  buf_set_buf(), hexify() and unhexify() give the same results as the bit
+  at a time versions they replaced, then times both on the same data.
+
+  The helpers are built from the source tree, no configured build tree is
+  needed. To compile run, from this directory:
+  gcc -Wall -O2 -std=gnu99 -I../../src -o binarybuffer_bench binarybuffer_bench.c
+
+  Usage:
+  ./binarybuffer_bench [iterations]
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Keep out log.h and replacements.h, which need a configured build tree,
+ * and provide the few definitions binarybuffer.c takes from them */
+#define OPENOCD_HELPER_LOG_H
+#define OPENOCD_HELPER_REPLACEMENTS_H
+#define ERROR_OK	(0)
+#define ERROR_FAIL	(-4)
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#include "helper/binarybuffer.c"
+
+#define BUF_SIZE	4096
+
+/* The implementations before the byte-parallel rework */
+
+static void old_buf_set_u32(uint8_t *buffer, unsigned first, unsigned num, uint32_t value)
+{
+	if ((num == 32) && (first == 0)) {
+		buffer[3] = (value >> 24) & 0xff;
+		buffer[2] = (value >> 16) & 0xff;
+		buffer[1] = (value >> 8) & 0xff;
+		buffer[0] = (value >> 0) & 0xff;
+	} else {
+		for (unsigned i = first; i < first + num; i++) {
+			if (((value >> (i - first)) & 1) == 1)
+				buffer[i / 8] |= 1 << (i % 8);
+			else
+				buffer[i / 8] &= ~(1 << (i % 8));
+		}
+	}
+}
+
+static void old_buf_set_u64(uint8_t *buffer, unsigned first, unsigned num, uint64_t value)
+{
+	if ((num == 32) && (first == 0)) {
+		old_buf_set_u32(buffer, 0, 32, value);
+	} else if ((num == 64) && (first == 0)) {
+		for (unsigned i = 0; i < 8; i++)
+			buffer[i] = (value >> (8 * i)) & 0xff;
+	} else {
+		for (unsigned i = first; i < first + num; i++) {
+			if (((value >> (i - first)) & 1) == 1)
+				buffer[i / 8] |= 1 << (i % 8);
+			else
+				buffer[i / 8] &= ~(1 << (i % 8));
+		}
+	}
+}
+
+static uint32_t old_buf_get_u32(const uint8_t *buffer, unsigned first, unsigned num)
+{
+	if ((num == 32) && (first == 0)) {
+		return (((uint32_t)buffer[3]) << 24) |
+				(((uint32_t)buffer[2]) << 16) |
+				(((uint32_t)buffer[1]) << 8) |
+				(((uint32_t)buffer[0]) << 0);
+	} else {
+		uint32_t result = 0;
+		for (unsigned i = first; i < first + num; i++) {
+			if (((buffer[i / 8] >> (i % 8)) & 1) == 1)
+				result |= 1U << (i - first);
+		}
+		return result;
+	}
+}
+
+static uint64_t old_buf_get_u64(const uint8_t *buffer, unsigned first, unsigned num)
+{
+	if ((num == 32) && (first == 0)) {
+		return old_buf_get_u32(buffer, 0, 32);
+	} else if ((num == 64) && (first == 0)) {
+		uint64_t result = 0;
+		for (unsigned i = 0; i < 8; i++)
+			result |= (uint64_t)buffer[i] << (8 * i);
+		return result;
+	} else {
+		uint64_t result = 0;
+		for (unsigned i = first; i < first + num; i++) {
+			if (((buffer[i / 8] >> (i % 8)) & 1) == 1)
+				result = result | ((uint64_t)1 << (uint64_t)(i - first));
+		}
+		return result;
+	}
+}
+
+static void *old_buf_set_buf(const void *_src, unsigned src_start,
+	void *_dst, unsigned dst_start, unsigned len)
+{
+	const uint8_t *src = _src;
+	uint8_t *dst = _dst;
+	unsigned i, sb, db, sq, dq, lb, lq;
+
+	sb = src_start / 8;
+	db = dst_start / 8;
+	sq = src_start % 8;
+	dq = dst_start % 8;
+	lb = len / 8;
+	lq = len % 8;
+
+	src += sb;
+	dst += db;
+
+	if ((sq == 0) && (dq == 0) &&  (lq == 0)) {
+		for (i = 0; i < lb; i++)
+			*dst++ = *src++;
+		return _dst;
+	}
+
+	for (i = 0; i < len; i++) {
+		if (((*src >> (sq & 7)) & 1) == 1)
+			*dst |= 1 << (dq & 7);
+		else
+			*dst &= ~(1 << (dq & 7));
+		if (sq++ == 7) {
+			sq = 0;
+			src++;
+		}
+		if (dq++ == 7) {
+			dq = 0;
+			dst++;
+		}
+	}
+
+	return _dst;
+}
+
+static size_t old_unhexify(uint8_t *bin, const char *hex, size_t count)
+{
+	size_t i;
+	char tmp;
+
+	memset(bin, 0, count);
+
+	for (i = 0; i < 2 * count; i++) {
+		if (hex[i] >= 'a' && hex[i] <= 'f')
+			tmp = hex[i] - 'a' + 10;
+		else if (hex[i] >= 'A' && hex[i] <= 'F')
+			tmp = hex[i] - 'A' + 10;
+		else if (hex[i] >= '0' && hex[i] <= '9')
+			tmp = hex[i] - '0';
+		else
+			return i / 2;
+
+		bin[i / 2] |= tmp << (4 * ((i + 1) % 2));
+	}
+
+	return i / 2;
+}
+
+static size_t old_hexify(char *hex, const uint8_t *bin, size_t count, size_t length)
+{
+	size_t i;
+
+	if (!length)
+		return 0;
+
+	for (i = 0; i < length - 1 && i < 2 * count; i++)
+		hex[i] = "0123456789abcdef"[(bin[i / 2] >> (4 * ((i + 1) % 2))) & 0x0f];
+
+	hex[i] = 0;
+
+	return i;
+}
+
+/* The benchmarks, each runs one implementation over the same fields */
+
+struct field {
+	unsigned int first;
+	unsigned int num;
+	uint64_t value;
+};
+
+#define NUM_FIELDS	1024
+
+static struct field fields[NUM_FIELDS];
+static uint8_t src_buf[BUF_SIZE], dst_buf[BUF_SIZE], ref_buf[BUF_SIZE];
+static char hex_buf[2 * BUF_SIZE + 1];
+static volatile uint64_t sink;
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void run_set_u32(bool old)
+{
+	for (unsigned int i = 0; i < NUM_FIELDS; i++) {
+		unsigned int num = fields[i].num > 32 ? 32 : fields[i].num;
+
+		if (old)
+			old_buf_set_u32(dst_buf, fields[i].first, num, fields[i].value);
+		else
+			buf_set_u32(dst_buf, fields[i].first, num, fields[i].value);
+	}
+}
+
+static void run_get_u32(bool old)
+{
+	uint64_t sum = 0;
+
+	for (unsigned int i = 0; i < NUM_FIELDS; i++) {
+		unsigned int num = fields[i].num > 32 ? 32 : fields[i].num;
+
+		if (old)
+			sum += old_buf_get_u32(src_buf, fields[i].first, num);
+		else
+			sum += buf_get_u32(src_buf, fields[i].first, num);
+	}
+	sink = sum;
+}
+
+static void run_set_u64(bool old)
+{
+	for (unsigned int i = 0; i < NUM_FIELDS; i++) {
+		if (old)
+			old_buf_set_u64(dst_buf, fields[i].first, fields[i].num, fields[i].value);
+		else
+			buf_set_u64(dst_buf, fields[i].first, fields[i].num, fields[i].value);
+	}
+}
+
+static void run_get_u64(bool old)
+{
+	uint64_t sum = 0;
+
+	for (unsigned int i = 0; i < NUM_FIELDS; i++) {
+		if (old)
+			sum += old_buf_get_u64(src_buf, fields[i].first, fields[i].num);
+		else
+			sum += buf_get_u64(src_buf, fields[i].first, fields[i].num);
+	}
+	sink = sum;
+}
+
+/* unaligned copies of a typical scan length */
+static void run_set_buf(bool old)
+{
+	for (unsigned int i = 0; i < 64; i++) {
+		unsigned int src_start = fields[i].first % 8 + 8 * i;
+		unsigned int dst_start = (fields[i].first + 3) % 8 + 8 * i;
+		unsigned int len = 8 * (BUF_SIZE - 16 * 8) - 3;
+
+		if (old)
+			old_buf_set_buf(src_buf, src_start, dst_buf, dst_start, len);
+		else
+			buf_set_buf(src_buf, src_start, dst_buf, dst_start, len);
+	}
+}
+
+static void run_hexify(bool old)
+{
+	if (old)
+		old_hexify(hex_buf, src_buf, BUF_SIZE, sizeof(hex_buf));
+	else
+		hexify(hex_buf, src_buf, BUF_SIZE, sizeof(hex_buf));
+}
+
+static void run_unhexify(bool old)
+{
+	if (old)
+		old_unhexify(dst_buf, hex_buf, BUF_SIZE);
+	else
+		unhexify(dst_buf, hex_buf, BUF_SIZE);
+}
+
+static const struct {
+	const char *name;
+	void (*run)(bool old);
+} benchmarks[] = {
+	{ "buf_set_u32", run_set_u32 },
+	{ "buf_get_u32", run_get_u32 },
+	{ "buf_set_u64", run_set_u64 },
+	{ "buf_get_u64", run_get_u64 },
+	{ "buf_set_buf", run_set_buf },
+	{ "hexify", run_hexify },
+	{ "unhexify", run_unhexify },
+};
+
+/* Run both versions on the same input, the outputs have to be identical */
+static bool check(unsigned int b)
+{
+	uint64_t old_sink;
+
+	memset(dst_buf, 0x5a, sizeof(dst_buf));
+	hexify(hex_buf, src_buf, BUF_SIZE, sizeof(hex_buf));
+	benchmarks[b].run(true);
+	old_sink = sink;
+	memcpy(ref_buf, dst_buf, sizeof(ref_buf));
+	char *old_hex = strdup(hex_buf);
+
+	memset(dst_buf, 0x5a, sizeof(dst_buf));
+	hexify(hex_buf, src_buf, BUF_SIZE, sizeof(hex_buf));
+	benchmarks[b].run(false);
+
+	bool ok = old_sink == sink && !memcmp(ref_buf, dst_buf, sizeof(dst_buf)) &&
+		!strcmp(old_hex, hex_buf);
+	free(old_hex);
+	return ok;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 2000;
+	bool failed = false;
+
+	srand(1);
+	for (unsigned int i = 0; i < BUF_SIZE; i++)
+		src_buf[i] = rand();
+	for (unsigned int i = 0; i < NUM_FIELDS; i++) {
+		fields[i].num = 1 + rand() % 64;
+		fields[i].first = rand() % (8 * (BUF_SIZE - 8));
+		fields[i].value = ((uint64_t)rand() << 33) ^ ((uint64_t)rand() << 11) ^ rand();
+		if (fields[i].num < 64)
+			fields[i].value &= (1ULL << fields[i].num) - 1;
+	}
+
+	printf("%-12s %12s %12s %8s\n", "", "old ns/op", "new ns/op", "speedup");
+
+	for (unsigned int b = 0; b < ARRAY_SIZE(benchmarks); b++) {
+		if (!check(b)) {
+			printf("%-12s results differ\n", benchmarks[b].name);
+			failed = true;
+			continue;
+		}
+
+		double t[2];
+		for (unsigned int old = 0; old < 2; old++) {
+			double start = now();
+			for (unsigned int i = 0; i < iterations; i++)
+				benchmarks[b].run(old);
+			t[old] = (now() - start) * 1e9 / iterations;
+		}
+
+		printf("%-12s %12.0f %12.0f %7.1fx\n", benchmarks[b].name, t[1], t[0], t[1] / t[0]);
+	}
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+  Microbenchmark of the slice-by-8 CRC32 code in src/helper/crc32.c.
+  It checks that crc32_be() and crc32_le() give the same results as the
+  byte at a time table loop image_calculate_checksum() used before and
+  the bit-serial crc32_le() they replaced, then times both on the same
+  data.
+
+  To compile run, from this directory:
+  gcc -Wall -O2 -std=gnu99 -I../../src -o crc32_bench crc32_bench.c ../../src/helper/crc32.c
+
+  Usage:
+  ./crc32_bench [size in KiB]
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "helper/crc32.h"
+
+/* The byte at a time table loop of image_calculate_checksum(), as per gdb */
+static uint32_t old_crc32_be(uint32_t crc, const uint8_t *buffer, size_t nbytes)
+{
+	static uint32_t crc32_table[256];
+	static bool first_init;
+
+	if (!first_init) {
+		unsigned int i, j, c;
+		for (i = 0; i < 256; i++) {
+			for (c = i << 24, j = 8; j > 0; --j)
+				c = c & 0x80000000 ? (c << 1) ^ CRC32_POLY_BE : (c << 1);
+			crc32_table[i] = c;
+		}
+
+		first_init = true;
+	}
+
+	while (nbytes--)
+		crc = (crc << 8) ^ crc32_table[((crc >> 24) ^ *buffer++) & 255];
+
+	return crc;
+}
+
+/* The bit-serial crc32_le(), memory byte order on all hosts */
+static uint32_t old_crc32_le(uint32_t crc, const uint8_t *data, size_t data_len)
+{
+	for (size_t n = 0; n < data_len; n++) {
+		for (unsigned int i = 0; i < 8; i++) {
+			uint32_t d, c;
+			d = ((data[n] >> i) & 0x1) ? 0xffffffff : 0;
+			c = (crc & 0x1) ? 0xffffffff : 0;
+			crc = crc >> 1;
+			crc = crc ^ ((d ^ c) & CRC32_POLY_LE);
+		}
+	}
+
+	return crc;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* MiB/s of @a fn over @a size bytes, repeated for about 0.2 s */
+static double measure(uint32_t (*fn)(const uint8_t *data, size_t size),
+		const uint8_t *data, size_t size)
+{
+	volatile uint32_t sink;
+	unsigned int rounds = 0;
+	double start = now(), elapsed;
+
+	do {
+		sink = fn(data, size);
+		rounds++;
+		elapsed = now() - start;
+	} while (elapsed < 0.2);
+	(void)sink;
+
+	return size * (double)rounds / elapsed / (1024 * 1024);
+}
+
+static uint32_t run_old_be(const uint8_t *data, size_t size)
+{
+	return old_crc32_be(0xffffffff, data, size);
+}
+
+static uint32_t run_new_be(const uint8_t *data, size_t size)
+{
+	return crc32_be(CRC32_POLY_BE, 0xffffffff, data, size);
+}
+
+static uint32_t run_old_le(const uint8_t *data, size_t size)
+{
+	return old_crc32_le(0xffffffff, data, size);
+}
+
+static uint32_t run_new_le(const uint8_t *data, size_t size)
+{
+	return crc32_le(CRC32_POLY_LE, 0xffffffff, data, size);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t size = (argc > 1 ? strtoul(argv[1], NULL, 0) : 1024) * 1024;
+	/* one byte more to also check unaligned data */
+	uint8_t *data = malloc(size + 1);
+	bool failed = false;
+
+	if (!data)
+		return 1;
+
+	srand(1);
+	for (size_t i = 0; i < size + 1; i++)
+		data[i] = rand();
+
+	/* all lengths up to a few slices, at both alignments, then the whole buffer */
+	for (size_t len = 0; len < 64 && len <= size; len++) {
+		for (unsigned int offset = 0; offset < 2; offset++) {
+			if (run_old_be(data + offset, len) != run_new_be(data + offset, len) ||
+					run_old_le(data + offset, len) != run_new_le(data + offset, len))
+				failed = true;
+		}
+	}
+	if (run_old_be(data + 1, size) != run_new_be(data + 1, size) ||
+			run_old_le(data + 1, size) != run_new_le(data + 1, size))
+		failed = true;
+
+	if (failed) {
+		printf("results differ\n");
+		return 1;
+	}
+
+	printf("%-12s %12s %12s %8s\n", "", "old MiB/s", "new MiB/s", "speedup");
+
+	double old_be = measure(run_old_be, data, size);
+	double new_be = measure(run_new_be, data, size);
+	printf("%-12s %12.1f %12.1f %7.1fx\n", "crc32_be", old_be, new_be, new_be / old_be);
+
+	double old_le = measure(run_old_le, data, size);
+	double new_le = measure(run_new_le, data, size);
+	printf("%-12s %12.1f %12.1f %7.1fx\n", "crc32_le", old_le, new_le, new_le / old_le);
+
+	free(data);
+
+	return 0;
+}